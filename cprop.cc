@@ -20,8 +20,11 @@
 # include "config.h"
 
 # include  <algorithm>
+# include  <deque>
+# include  <set>
 # include  <vector>
 # include  <cstdlib>
+# include  <ctime>
 # include  "netlist.h"
 # include  "netmisc.h"
 # include  "functor.h"
@@ -34,12 +37,27 @@
  * possible. The elaboration generates NetConst objects. I can remove
  * these and replace the gates connected to it with simpler ones. I
  * may even be able to replace nets with a new constant.
+ *
+ * The design is scanned once. After that, only the nodes around a
+ * Nexus that an optimization changed can have become optimizable, so
+ * those are put on a work list and visited until the list is empty.
  */
 
 struct cprop_functor  : public functor_t {
 
       unsigned count;
 
+	// Nodes that need another look. The set holds the nodes that
+	// are on the list and still exist, and the list may have
+	// stale entries that are skipped.
+      std::deque<NetNode*> work_list;
+      std::set<NetNode*> work_set;
+
+      void enqueue(NetNode*obj);
+      void enqueue_nexus(Nexus*nex);
+      void delete_node(NetNode*obj);
+      unsigned run_work_list(Design*des);
+
       virtual void signal(Design*des, NetNet*obj);
       virtual void lpm_add_sub(Design*des, NetAddSub*obj);
       virtual void lpm_compare(Design*des, NetCompare*obj);
@@ -52,6 +70,44 @@ struct cprop_functor  : public functor_t {
       void lpm_compare_eq_(Design*des, NetCompare*obj);
  };
 
+void cprop_functor::enqueue(NetNode*obj)
+{
+      if (work_set.insert(obj).second)
+	    work_list.push_back(obj);
+}
+
+/*
+ * Put all the nodes connected to the nexus on the work list.
+ */
+void cprop_functor::enqueue_nexus(Nexus*nex)
+{
+      for (Link*cur = nex->first_nlink() ; cur ; cur = cur->next_nlink()) {
+	    if (NetNode*obj = dynamic_cast<NetNode*>(cur->get_obj()))
+		  enqueue(obj);
+      }
+}
+
+void cprop_functor::delete_node(NetNode*obj)
+{
+      work_set.erase(obj);
+      delete obj;
+}
+
+unsigned cprop_functor::run_work_list(Design*des)
+{
+      unsigned visits = 0;
+      while (! work_list.empty()) {
+	    NetNode*obj = work_list.front();
+	    work_list.pop_front();
+	    if (work_set.erase(obj) == 0)
+		  continue;
+
+	    visits += 1;
+	    obj->functor_node(des, this);
+      }
+      return visits;
+}
+
 void cprop_functor::signal(Design*, NetNet*)
 {
 }
@@ -117,7 +173,8 @@ void cprop_functor::lpm_concat(Design*des, NetConcat*obj)
 
 	// Note that this will leave the const inputs to dangle. They
 	// will be reaped by other passes of cprop_functor.
-      delete obj;
+      delete_node(obj);
+      enqueue_nexus(result_obj->pin(0).nexus());
 
       count += 1;
 }
@@ -135,7 +192,7 @@ void cprop_functor::lpm_ff(Design*, NetFF*obj)
 	  && (! obj->pin_Aset().is_linked())) {
 	    obj->pin_Data().unlink();
 	    obj->pin_Q().unlink();
-	    delete obj;
+	    delete_node(obj);
       }
 }
 
@@ -188,8 +245,9 @@ void cprop_functor::lpm_mux(Design*des, NetMux*obj)
 	    connect(tmp->pin(1), obj->pin_Data(1));
       else
 	    connect(tmp->pin(1), obj->pin_Data(0));
-      delete obj;
+      delete_node(obj);
       des->add_node(tmp);
+      enqueue_nexus(tmp->pin(0).nexus());
       count += 1;
 }
 
@@ -323,9 +381,12 @@ void cprop_functor::lpm_part_select(Design*des, NetPartSelect*obj)
       ivl_assert(*obj, concat_pin == concat->pin_count());
 
       for (size_t idx = 0 ; idx < obj_set.size() ; idx += 1) {
-	    delete obj_set[idx];
+	    delete_node(obj_set[idx]);
       }
 
+	// The new concatenation may itself be constant.
+      enqueue_nexus(concat->pin(0).nexus());
+
       count += 1;
 }
 
@@ -428,17 +489,29 @@ void cprop_dc_functor::lpm_const(Design*, NetConst*obj)
 
 void cprop(Design*des)
 {
-	// Continually propagate constants until a scan finds nothing
+	// Scan the whole design once, then propagate constants from
+	// the nodes that the scan changed until there is nothing left
 	// to do.
       cprop_functor prop;
-      do {
-	    prop.count = 0;
-	    des->functor(&prop);
-	    if (verbose_flag) {
-		  cout << " ... Iteration detected "
-		       << prop.count << " optimizations." << endl << flush;
-	    }
-      } while (prop.count > 0);
+      prop.count = 0;
+      clock_t start = clock();
+      des->functor(&prop);
+      if (verbose_flag) {
+	    cout << " ... Full scan detected " << prop.count
+		 << " optimizations ("
+		 << (double)(clock() - start) / CLOCKS_PER_SEC
+		 << " seconds)." << endl << flush;
+      }
+
+      prop.count = 0;
+      start = clock();
+      unsigned visits = prop.run_work_list(des);
+      if (verbose_flag) {
+	    cout << " ... Work list visited " << visits << " nodes and"
+		 << " detected " << prop.count << " optimizations ("
+		 << (double)(clock() - start) / CLOCKS_PER_SEC
+		 << " seconds)." << endl << flush;
+      }
 
       if (verbose_flag) {
 	    cout << " ... Look for dangling constants" << endl << flush;
@@ -20,6 +20,7 @@
  */
 
 # include  <stddef.h>
+# include  <stdio.h>
 
   /* This is the integer-width argument that will be passed to ivl. */
 extern unsigned integer_width;
@@ -54,4 +55,30 @@ extern void process_parameter(const char*name);
   /* Set the default timescale for the simulator. */
 extern void process_timescale(const char*ts_string);
 
+  /* The directory separator character for this platform. */
+extern const char sep;
+
+  /* Preprocessor output cache (ppcache.c). ppcache_open() starts a
+     compile and ppcache_close() ends it. For each source file in
+     order, ppcache_entry() computes the cache entry from the file and
+     the precompiled defines of the file before it, and returns its
+     base path or nil if the cache cannot be used. ppcache_lookup()
+     returns true if the entry is current. After a miss the
+     preprocessor writes to ppcache_temp_path(".pp"), (".def") and
+     (".inc"), and ppcache_store() commits them or ppcache_discard()
+     removes them. */
+extern int ppcache_open(const char*dir, const char*flags,
+			const char*defines_path);
+extern const char* ppcache_flags_path(void);
+extern void ppcache_close(void);
+extern const char* ppcache_entry(const char*state_path,
+				 const char*source_file);
+extern int ppcache_lookup(void);
+extern const char* ppcache_output_path(void);
+extern const char* ppcache_defines_path(void);
+extern const char* ppcache_temp_path(const char*suffix);
+extern int ppcache_store(void);
+extern void ppcache_discard(void);
+extern int ppcache_copy_defines(const char*path);
+
 #endif /* IVL_globals_H */
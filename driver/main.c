@@ -42,7 +42,7 @@ const char HELP[] =
 "                [-g1995|-g2001|-g2005|-g2005-sv|-g2009|-g2012] [-g<feature>]\n"
 "                [-D macro[=defn]] [-I includedir]\n"
 "                [-M [mode=]depfile] [-m module]\n"
-"                [-N file] [-o filename] [-p flag=value]\n"
+"                [-N file] [-o filename] [-p flag=value] [-R cachedir]\n"
 "                [-s topmodule] [-t target] [-T min|typ|max]\n"
 "                [-W class] [-y dir] [-Y suf] [-l file] source_file(s)\n"
 "\n"
@@ -55,12 +55,16 @@ const char HELP[] =
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <signal.h>
 #include <assert.h>
 
 #include <sys/types.h>
 #ifdef HAVE_SYS_WAIT_H
 #include <sys/wait.h>
 #endif
+#ifndef __MINGW32__
+#include <sys/time.h>
+#endif
 
 #ifdef __MINGW32__
 # include  <windows.h>
@@ -114,6 +118,7 @@ const char*opath = "a.out";
 const char*npath = 0;
 const char*targ  = "vvp";
 const char*depfile = 0;
+const char*pp_cache_dir = 0;
 
 const char**vhdlpp_libdir = 0;
 unsigned vhdlpp_libdir_cnt = 0;
@@ -311,6 +316,285 @@ static const char*my_tempfile(const char*str, FILE**fout)
       return pathbuf;
 }
 
+/*
+ * Write the nil terminated list of files, in order, to the stream.
+ * Return 0 if a file cannot be read or the stream cannot be written.
+ */
+static int write_input_files(FILE*dst, const char*const*input)
+{
+      char buf[8192];
+      size_t cnt;
+      int rc = 1;
+
+      for (unsigned idx = 0 ; rc && input[idx] ; idx += 1) {
+	    FILE*src = fopen(input[idx], "rb");
+	    if (src == 0) {
+		  perror(input[idx]);
+		  rc = 0;
+		  break;
+	    }
+	    while ((cnt = fread(buf, 1, sizeof buf, src)) > 0) {
+		  if (fwrite(buf, 1, cnt, dst) != cnt) {
+			rc = 0;
+			break;
+		  }
+	    }
+	    fclose(src);
+      }
+
+      return rc;
+}
+
+#ifndef __MINGW32__
+/*
+ * Split a command line, as it would be written for the shell, into
+ * the argument lists of the stages of a pipeline. The commands built
+ * here only use double quotes, back slash escapes, white space and
+ * the pipe character, so that is all this handles. The result is a
+ * nil terminated list of nil terminated argument lists.
+ */
+static char***split_pipeline(const char*cmd)
+{
+      char***stages = calloc(1, sizeof(char**));
+      unsigned nstages = 0;
+      char**args = 0;
+      unsigned nargs = 0;
+      char*word = malloc(strlen(cmd)+1);
+      unsigned nword = 0;
+      int in_word = 0;
+      int quoted = 0;
+
+      for (const char*cp = cmd ; ; cp += 1) {
+	    int end_word = 0, end_stage = 0;
+
+	    if (*cp == 0) {
+		  end_word = 1;
+		  end_stage = 1;
+	    } else if (quoted && *cp == '"') {
+		  quoted = 0;
+	    } else if (quoted && *cp == '\\' && strchr("$`\"\\", cp[1])) {
+		  cp += 1;
+		  word[nword++] = *cp;
+	    } else if (quoted) {
+		  word[nword++] = *cp;
+	    } else if (*cp == '"') {
+		  quoted = 1;
+		  in_word = 1;
+	    } else if (*cp == '\\' && cp[1]) {
+		  cp += 1;
+		  word[nword++] = *cp;
+		  in_word = 1;
+	    } else if (*cp == '|') {
+		  end_word = 1;
+		  end_stage = 1;
+	    } else if (*cp == ' ' || *cp == '\t' || *cp == '\n') {
+		  end_word = 1;
+	    } else {
+		  word[nword++] = *cp;
+		  in_word = 1;
+	    }
+
+	    if (end_word && (in_word || nword > 0)) {
+		  word[nword] = 0;
+		  args = realloc(args, (nargs+2)*sizeof(char*));
+		  args[nargs++] = strdup(word);
+		  args[nargs] = 0;
+		  nword = 0;
+		  in_word = 0;
+	    }
+
+	    if (end_stage && args) {
+		  stages = realloc(stages, (nstages+2)*sizeof(char**));
+		  stages[nstages++] = args;
+		  stages[nstages] = 0;
+		  args = 0;
+		  nargs = 0;
+	    }
+
+	    if (*cp == 0)
+		  break;
+      }
+
+      free(word);
+      return stages;
+}
+
+static void free_pipeline(char***stages)
+{
+      for (unsigned idx = 0 ; stages[idx] ; idx += 1) {
+	    for (unsigned arg = 0 ; stages[idx][arg] ; arg += 1)
+		  free(stages[idx][arg]);
+	    free(stages[idx]);
+      }
+      free(stages);
+}
+
+static double seconds_since(const struct timeval*start)
+{
+      struct timeval now;
+      gettimeofday(&now, 0);
+      return (double)(now.tv_sec - start->tv_sec)
+	    + (double)(now.tv_usec - start->tv_usec) / 1000000.0;
+}
+
+/*
+ * Run the command line as a pipeline of processes directly, without
+ * a shell. The output of each stage streams into the next through a
+ * pipe, so ivl parses while ivlpp is still preprocessing. If input is
+ * not nil, it is a list of files that this process writes into the
+ * first stage. The result is a wait status like system() returns. It
+ * is the status of the last stage, or of an earlier stage that failed
+ * if the last stage did not. With -v, print the time each stage
+ * finished.
+ */
+static int run_command(const char*cmd, const char*const*input)
+{
+      char***stages = split_pipeline(cmd);
+      unsigned nstages = 0;
+      while (stages[nstages])
+	    nstages += 1;
+
+      if (nstages == 0) {
+	    free_pipeline(stages);
+	    return 0;
+      }
+
+      pid_t*pids = calloc(nstages, sizeof(pid_t));
+      int*status = calloc(nstages, sizeof(int));
+      double*done = calloc(nstages, sizeof(double));
+      struct timeval start;
+      int in_fd = -1;
+      FILE*feed = 0;
+
+      fflush(0);
+      gettimeofday(&start, 0);
+
+	/* The write end of the input pipe is not inherited by the
+	   stages, so the first stage sees the end of its input when
+	   this process closes it. */
+      if (input) {
+	    int fds[2];
+	    if (pipe(fds) != 0) {
+		  perror("pipe");
+		  free(done);
+		  free(status);
+		  free(pids);
+		  free_pipeline(stages);
+		  return 127 << 8;
+	    }
+	    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+	    in_fd = fds[0];
+	    feed = fdopen(fds[1], "wb");
+      }
+
+      for (unsigned idx = 0 ; idx < nstages ; idx += 1) {
+	    int fds[2] = { -1, -1 };
+	    if (idx+1 < nstages && pipe(fds) != 0) {
+		  perror("pipe");
+		  break;
+	    }
+
+	    pids[idx] = fork();
+	    if (pids[idx] == 0) {
+		  if (in_fd >= 0) {
+			dup2(in_fd, 0);
+			close(in_fd);
+		  }
+		  if (fds[1] >= 0) {
+			dup2(fds[1], 1);
+			close(fds[1]);
+			close(fds[0]);
+		  }
+		  execvp(stages[idx][0], stages[idx]);
+		  fprintf(stderr, "Failed to execute: %s: %s\n",
+			  stages[idx][0], strerror(errno));
+		  _exit(127);
+	    }
+
+	    if (pids[idx] < 0)
+		  perror("fork");
+
+	    if (in_fd >= 0)
+		  close(in_fd);
+	    if (fds[1] >= 0)
+		  close(fds[1]);
+	    in_fd = fds[0];
+
+	    if (pids[idx] < 0)
+		  break;
+      }
+
+      if (in_fd >= 0)
+	    close(in_fd);
+
+      if (feed) {
+	      /* If the first stage exits early, the write fails
+		 instead of killing this process, and the status of
+		 the stage reports the problem. */
+	    void (*save_pipe)(int) = signal(SIGPIPE, SIG_IGN);
+	    write_input_files(feed, input);
+	    fclose(feed);
+	    signal(SIGPIPE, save_pipe);
+      }
+
+	/* Collect the stages as they finish, noting the time of each. */
+      for (unsigned left = nstages ; left > 0 ; left -= 1) {
+	    int wstatus;
+	    pid_t pid = wait(&wstatus);
+	    if (pid < 0 && errno == EINTR) {
+		  left += 1;
+		  continue;
+	    }
+	    if (pid < 0)
+		  break;
+
+	    for (unsigned idx = 0 ; idx < nstages ; idx += 1) {
+		  if (pids[idx] != pid)
+			continue;
+		  status[idx] = wstatus;
+		  done[idx] = seconds_since(&start);
+	    }
+      }
+
+      int rc = status[nstages-1];
+      for (unsigned idx = 0 ; idx < nstages && rc == 0 ; idx += 1) {
+	    if (pids[idx] <= 0)
+		  rc = 127 << 8;
+	    else
+		  rc = status[idx];
+      }
+
+      if (verbose_flag) {
+	    for (unsigned idx = 0 ; idx < nstages ; idx += 1) {
+		  if (pids[idx] <= 0)
+			continue;
+		  const char*name = strrchr(stages[idx][0], sep);
+		  name = name ? name+1 : stages[idx][0];
+		  printf("%-10s: done at %.3f s\n", name, done[idx]);
+	    }
+      }
+
+      free(done);
+      free(status);
+      free(pids);
+      free_pipeline(stages);
+      return rc;
+}
+#else
+static int run_command(const char*cmd, const char*const*input)
+{
+      if (input == 0)
+	    return system(cmd);
+
+      fflush(0);
+      FILE*feed = _popen(cmd, "wb");
+      if (feed == 0)
+	    return 127;
+      write_input_files(feed, input);
+      return _pclose(feed);
+}
+#endif
+
 static int t_version_only(void)
 {
       int rc;
@@ -357,6 +641,143 @@ static void build_preprocess_command(int e_flag)
 	       e_flag ? "" : " | ");
 }
 
+static void free_file_list(char**files)
+{
+      for (unsigned idx = 0 ; files[idx] ; idx += 1)
+	    free(files[idx]);
+      free(files);
+}
+
+/*
+ * Preprocess through the cache directory. Each source file is looked
+ * up in the cache on its own, with the macro state left by the files
+ * before it, and ivlpp is only run for the files that miss. Return 0
+ * and, in *out, the nil terminated list of the cached output files in
+ * order, which the caller feeds to ivl. Return -1 if the cache cannot
+ * be used and the caller should pipe from ivlpp as usual, or the exit
+ * code if the preprocessor failed.
+ */
+static int preprocess_cached(char***out)
+{
+      char line_buf[4096];
+      char state_path[4096+64];
+      char**files = calloc(1, sizeof(char*));
+      unsigned nfiles = 0;
+      FILE*list;
+      int rc = 0;
+      const char*redef = strchr(warning_flags, 'r') ? " -Wredef-all" :
+			 strchr(warning_flags, 'R') ? " -Wredef-chg" : "";
+
+      if (! ppcache_open(pp_cache_dir, redef, defines_path)) {
+	    free_file_list(files);
+	    return -1;
+      }
+
+	/* The source list file has one path per line, as written by
+	   process_file_name(). */
+      list = fopen(source_path, "r");
+      if (list == 0) {
+	    ppcache_close();
+	    free_file_list(files);
+	    return -1;
+      }
+
+      state_path[0] = 0;
+      while (rc == 0 && fgets(line_buf, sizeof line_buf, list) != 0) {
+	    char*tail = line_buf + strlen(line_buf);
+	    while (tail > line_buf && (tail[-1] == '\n' || tail[-1] == '\r'))
+		  *--tail = 0;
+	    if (line_buf[0] == 0)
+		  continue;
+
+	    if (ppcache_entry(state_path[0] ? state_path : 0, line_buf) == 0) {
+		  rc = -1;
+		  break;
+	    }
+
+	    if (ppcache_lookup()) {
+		  if (verbose_flag)
+			printf("preprocess: using cached %s\n",
+			       ppcache_output_path());
+
+	    } else {
+		    /* The first file gets the -D defines from the
+		       defines file, the rest get them in the state. */
+		  int len;
+		  if (state_path[0]) {
+			len = snprintf(tmp, sizeof tmp, "%s%civlpp%s -L%s "
+				       "-F\"%s\" -P\"%s\"",
+				       ivlpp_dir, sep,
+				       verbose_flag ? " -v" : "", redef,
+				       ppcache_flags_path(), state_path);
+		  } else {
+			len = snprintf(tmp, sizeof tmp, "%s%civlpp%s -L%s "
+				       "-F\"%s\"",
+				       ivlpp_dir, sep,
+				       verbose_flag ? " -v" : "", redef,
+				       defines_path);
+		  }
+		  len += snprintf(tmp+len, sizeof tmp - len, " -p\"%s\"",
+				  ppcache_temp_path(".def"));
+		  len += snprintf(tmp+len, sizeof tmp - len, " -o\"%s\"",
+				  ppcache_temp_path(".pp"));
+		  len += snprintf(tmp+len, sizeof tmp - len, " -i\"%s\"",
+				  ppcache_temp_path(".inc"));
+		  snprintf(tmp+len, sizeof tmp - len, " \"%s\"", line_buf);
+
+		  if (verbose_flag)
+			printf("preprocess: %s\n", tmp);
+
+		  int run_rc = run_command(tmp, 0);
+		  if (run_rc != 0) {
+			ppcache_discard();
+			if (run_rc == 127) {
+			      fprintf(stderr, "Failed to execute: %s\n", tmp);
+			      rc = 1;
+			} else {
+			      fprintf(stderr, "errors preprocessing "
+				      "Verilog program.\n");
+			      if (WIFEXITED(run_rc) && WEXITSTATUS(run_rc))
+				    rc = WEXITSTATUS(run_rc);
+			      else
+				    rc = 1;
+			}
+			break;
+		  }
+
+		    /* If the entry cannot be committed, then give up on
+		       the cache and let the caller run ivlpp. */
+		  if (! ppcache_store()) {
+			ppcache_discard();
+			rc = -1;
+			break;
+		  }
+	    }
+
+	    files = realloc(files, (nfiles+2)*sizeof(char*));
+	    files[nfiles++] = strdup(ppcache_output_path());
+	    files[nfiles] = 0;
+	    strcpy(state_path, ppcache_defines_path());
+      }
+
+      fclose(list);
+      ppcache_close();
+
+	/* The macro state after the last file is the precompiled
+	   defines for the library files. */
+      if (rc == 0 && (state_path[0] == 0
+		      || ! ppcache_copy_defines(compiled_defines_path)))
+	    rc = -1;
+
+      if (rc != 0) {
+	    free_file_list(files);
+	    return rc;
+      }
+
+      *out = files;
+      return 0;
+}
+
 static int t_preprocess_only(void)
 {
       int rc;
@@ -416,10 +837,32 @@ static int t_preprocess_only(void)
 static int t_compile(void)
 {
       unsigned rc;
+      char**pp_out = 0;
+
+	/* With a cache directory, the preprocessed output comes from
+	   the files in the cache, which are written into ivl's input.
+	   The dependency file is written by ivlpp, so do not skip
+	   ivlpp if there is one. */
+      if (pp_cache_dir && !separate_compilation_flag && !depfile) {
+	    int pp_rc = preprocess_cached(&pp_out);
+	    if (pp_rc > 0) {
+		  if ( ! getenv("IVERILOG_ICONFIG")) {
+			remove(source_path);
+			free(source_path);
+			remove(iconfig_path);
+			free(iconfig_path);
+			remove(defines_path);
+			free(defines_path);
+			remove(compiled_defines_path);
+			free(compiled_defines_path);
+		  }
+		  return pp_rc;
+	    }
+      }
 
 	/* Start by building the preprocess command line, if required.
 	   This pipes into the main ivl command. */
-      if (!separate_compilation_flag)
+      if (!separate_compilation_flag && !pp_out)
 	    build_preprocess_command(0);
       else
 	    strcpy(tmp, "");
@@ -481,7 +924,9 @@ static int t_compile(void)
 	    printf("translate: %s\n", cmd);
 
 
-      rc = system(cmd);
+      rc = run_command(cmd, (const char*const*)pp_out);
+      if (pp_out)
+	    free_file_list(pp_out);
       if ( ! getenv("IVERILOG_ICONFIG")) {
 	    remove(source_path);
 	    free(source_path);
@@ -1028,7 +1473,7 @@ int main(int argc, char **argv)
 	}
       }
 
-      while ((opt = getopt(argc, argv, "B:c:D:d:Ef:g:hl:I:iM:m:N:o:P:p:Ss:T:t:uvVW:y:Y:")) != EOF) {
+      while ((opt = getopt(argc, argv, "B:c:D:d:Ef:g:hl:I:iM:m:N:o:P:p:R:Ss:T:t:uvVW:y:Y:")) != EOF) {
 
 	    switch (opt) {
 		case 'B':
@@ -1109,6 +1554,10 @@ int main(int argc, char **argv)
 		  opath = optarg;
 		  break;
 
+		case 'R':
+		  pp_cache_dir = optarg;
+		  break;
+
 		case 'S':
 		  synth_flag = 1;
 		  break;
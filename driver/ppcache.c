@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This is the preprocessor output cache (iverilog -R <dir>). Each
+ * source file is preprocessed on its own and kept in the cache
+ * directory under a key that is the hash of everything that goes into
+ * ivlpp for that file: the defines file (the -D defines and -I include
+ * directories), the macro state left by the source files before it,
+ * the path and contents of the file and the current directory. An
+ * entry is made of these files:
+ *
+ *    <key>.pp   - The ivlpp output, with line directives
+ *    <key>.def  - The precompiled defines after the file
+ *    <key>.inc  - The hash and path of each file that was included
+ *
+ * The macro state runs across the source files in order, so the .def
+ * of one file is passed to ivlpp (-P) for the next, and its contents
+ * are part of the key of the next. The -D defines are already in that
+ * state, so after the first file ivlpp gets a copy of the defines file
+ * without them (ppcache_flags_path()), or a `undef of a -D define would
+ * be lost.
+ *
+ * Everything is written to a temporary file and renamed into place.
+ * The .inc file is renamed last, so an entry without it is not
+ * complete and is not used. An entry is only used if each included
+ * file still has the hash that was recorded.
+ */
+
+# include  "config.h"
+# include  "version_base.h"
+# include  <stdio.h>
+# include  <stdlib.h>
+# include  <string.h>
+# include  <errno.h>
+# include  <stdint.h>
+# include  <unistd.h>
+# include  <sys/types.h>
+# include  <sys/stat.h>
+#ifdef __MINGW32__
+# include  <direct.h>
+#endif
+# include  "globals.h"
+
+  /* The entry paths are the base path with a short suffix. */
+static char entry_base[4096+32];
+static char entry_path[4096+64];
+
+  /* The cache directory, and the hash of the parts of the key that
+     are the same for all the source files of the compile. */
+static char cache_dir[4096];
+static uint64_t compile_hash;
+
+  /* The defines file without the -D defines. */
+static char flags_path[4096+32];
+
+static void hash_bytes(uint64_t*hash, const void*data, size_t len)
+{
+      const unsigned char*cp = (const unsigned char*)data;
+      for (size_t idx = 0 ; idx < len ; idx += 1) {
+	    *hash ^= cp[idx];
+	    *hash *= 0x100000001b3ULL;
+      }
+}
+
+static void hash_string(uint64_t*hash, const char*str)
+{
+	/* Include the terminating nul so that the strings "ab","c"
+	   and "a","bc" hash differently. */
+      hash_bytes(hash, str, strlen(str)+1);
+}
+
+/*
+ * Add the contents of the file to the hash. Return 0 if the file
+ * cannot be read.
+ */
+static int hash_file(uint64_t*hash, const char*path)
+{
+      char buf[8192];
+      size_t cnt;
+
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0)
+	    return 0;
+
+      while ((cnt = fread(buf, 1, sizeof buf, fd)) > 0)
+	    hash_bytes(hash, buf, cnt);
+
+      fclose(fd);
+      return 1;
+}
+
+static uint64_t hash_init(void)
+{
+      return 0xcbf29ce484222325ULL;
+}
+
+static const char*entry_file(const char*suffix)
+{
+      snprintf(entry_path, sizeof entry_path, "%s%s", entry_base, suffix);
+      return entry_path;
+}
+
+static int append_file(FILE*dst, const char*src_path)
+{
+      char buf[8192];
+      size_t cnt;
+      int rc = 1;
+
+      FILE*src = fopen(src_path, "rb");
+      if (src == 0)
+	    return 0;
+
+      while ((cnt = fread(buf, 1, sizeof buf, src)) > 0) {
+	    if (fwrite(buf, 1, cnt, dst) != cnt) {
+		  rc = 0;
+		  break;
+	    }
+      }
+
+      fclose(src);
+      return rc;
+}
+
+static void strip_newline(char*text)
+{
+      char*tail = text + strlen(text);
+      while (tail > text && (tail[-1] == '\n' || tail[-1] == '\r')) {
+	    tail -= 1;
+	    *tail = 0;
+      }
+}
+
+int ppcache_open(const char*dir, const char*flags, const char*defines_path)
+{
+      char line_buf[4096];
+      char cwd[4096];
+
+#ifdef __MINGW32__
+      if (_mkdir(dir) != 0 && errno != EEXIST) {
+#else
+      if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+#endif
+	    perror(dir);
+	    return 0;
+      }
+
+      snprintf(cache_dir, sizeof cache_dir, "%s", dir);
+
+      compile_hash = hash_init();
+      hash_string(&compile_hash, VERSION);
+      hash_string(&compile_hash, flags);
+      if (getcwd(cwd, sizeof cwd) != 0)
+	    hash_string(&compile_hash, cwd);
+      if (! hash_file(&compile_hash, defines_path))
+	    return 0;
+
+	/* Copy the defines file without the D: lines. */
+      snprintf(flags_path, sizeof flags_path, "%s%cflags.%ld",
+	       dir, sep, (long)getpid());
+
+      FILE*src = fopen(defines_path, "r");
+      if (src == 0)
+	    return 0;
+
+      FILE*dst = fopen(flags_path, "w");
+      if (dst == 0) {
+	    fclose(src);
+	    return 0;
+      }
+
+      while (fgets(line_buf, sizeof line_buf, src) != 0) {
+	    if (strncmp(line_buf, "D:", 2) != 0)
+		  fputs(line_buf, dst);
+      }
+
+      fclose(src);
+      if (fclose(dst) != 0) {
+	    remove(flags_path);
+	    return 0;
+      }
+
+      return 1;
+}
+
+const char* ppcache_flags_path(void)
+{
+      return flags_path;
+}
+
+void ppcache_close(void)
+{
+      remove(flags_path);
+}
+
+const char* ppcache_entry(const char*state_path, const char*source_file)
+{
+      uint64_t hash = compile_hash;
+
+	/* The first file has no state from before it. */
+      if (state_path) {
+	    hash_string(&hash, "state");
+	    if (! hash_file(&hash, state_path))
+		  return 0;
+      }
+
+      hash_string(&hash, source_file);
+      if (! hash_file(&hash, source_file))
+	    return 0;
+
+      snprintf(entry_base, sizeof entry_base, "%s%c%016llx",
+	       cache_dir, sep, (unsigned long long)hash);
+      return entry_base;
+}
+
+int ppcache_lookup(void)
+{
+      char line_buf[4096];
+
+      FILE*fd = fopen(entry_file(".inc"), "r");
+      if (fd == 0)
+	    return 0;
+
+      while (fgets(line_buf, sizeof line_buf, fd) != 0) {
+	    unsigned long long want;
+	    int pos;
+
+	    strip_newline(line_buf);
+	    if (sscanf(line_buf, "%llx %n", &want, &pos) != 1) {
+		  fclose(fd);
+		  return 0;
+	    }
+
+	    uint64_t hash = hash_init();
+	    if (! hash_file(&hash, line_buf+pos) || hash != want) {
+		  fclose(fd);
+		  return 0;
+	    }
+      }
+      fclose(fd);
+
+      if (access(entry_file(".pp"), R_OK) != 0)
+	    return 0;
+      if (access(entry_file(".def"), R_OK) != 0)
+	    return 0;
+
+      return 1;
+}
+
+const char* ppcache_output_path(void)
+{
+      return entry_file(".pp");
+}
+
+const char* ppcache_defines_path(void)
+{
+      return entry_file(".def");
+}
+
+const char* ppcache_temp_path(const char*suffix)
+{
+      snprintf(entry_path, sizeof entry_path, "%s%s.%ld",
+	       entry_base, suffix, (long)getpid());
+      return entry_path;
+}
+
+/*
+ * Commit the output of a preprocessor run that wrote its output,
+ * defines and include list to the temporary paths. If anything fails
+ * the entry is left incomplete, which only means the next compile
+ * misses.
+ */
+int ppcache_store(void)
+{
+      char line_buf[4096];
+      char tmp_path[sizeof entry_path];
+
+      strcpy(tmp_path, ppcache_temp_path(".pp"));
+      if (rename(tmp_path, entry_file(".pp")) != 0) {
+	    remove(tmp_path);
+	    return 0;
+      }
+
+      strcpy(tmp_path, ppcache_temp_path(".def"));
+      if (rename(tmp_path, entry_file(".def")) != 0) {
+	    remove(tmp_path);
+	    return 0;
+      }
+
+      strcpy(tmp_path, ppcache_temp_path(".inc"));
+      FILE*src = fopen(tmp_path, "r");
+      if (src == 0)
+	    return 0;
+
+      FILE*dst = fopen(ppcache_temp_path(".idx"), "w");
+      if (dst == 0) {
+	    fclose(src);
+	    remove(tmp_path);
+	    return 0;
+      }
+
+      int rc = 1;
+      while (fgets(line_buf, sizeof line_buf, src) != 0) {
+	    strip_newline(line_buf);
+	    uint64_t hash = hash_init();
+	    if (! hash_file(&hash, line_buf)) {
+		  rc = 0;
+		  break;
+	    }
+	    fprintf(dst, "%016llx %s\n", (unsigned long long)hash, line_buf);
+      }
+
+      fclose(src);
+      remove(tmp_path);
+      if (fclose(dst) != 0)
+	    rc = 0;
+
+      strcpy(tmp_path, ppcache_temp_path(".idx"));
+      if (rc == 0 || rename(tmp_path, entry_file(".inc")) != 0) {
+	    remove(tmp_path);
+	    return 0;
+      }
+
+      return 1;
+}
+
+/*
+ * Remove the temporary files of a preprocessor run that failed.
+ */
+void ppcache_discard(void)
+{
+      remove(ppcache_temp_path(".pp"));
+      remove(ppcache_temp_path(".def"));
+      remove(ppcache_temp_path(".inc"));
+}
+
+/*
+ * Copy the precompiled defines of the entry, which is the macro state
+ * after the last source file, for the library files.
+ */
+int ppcache_copy_defines(const char*path)
+{
+      FILE*dst = fopen(path, "wb");
+      if (dst == 0)
+	    return 0;
+
+      int rc = append_file(dst, entry_file(".def"));
+      if (fclose(dst) != 0)
+	    rc = 0;
+      return rc;
+}
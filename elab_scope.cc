@@ -839,6 +839,7 @@ bool Module::elaborate_scope(Design*des, NetScope*scope,
 		 ; cur != defparms.end() ; ++ cur ) {
 	    scope->defparams.push_back(make_pair(cur->first, cur->second));
       }
+      scope->mark_elab_dirty();
 
 	// Evaluate the attributes. Evaluate them in the scope of the
 	// module that the attribute is attached to. Is this correct?
@@ -1438,6 +1439,7 @@ void PGenerate::elaborate_subscope_(Design*des, NetScope*scope)
 		 ; cur != defparms.end() ; ++ cur ) {
 	    scope->defparams.push_back(make_pair(cur->first, cur->second));
       }
+      scope->mark_elab_dirty();
 
 	// Scan the generated scope for nested generate schemes,
 	// and *generate* new scopes, which is slightly different
@@ -1667,6 +1669,51 @@ void PGModule::elaborate_scope_mod_instances_(Design*des, Module*mod, NetScope*s
 	    unsigned attrib_list_n = 0;
 	    attrib_list = evaluate_attributes(attributes, attrib_list_n, des, sc);
 
+	// Look for module parameter replacements. The "replace" map
+	// maps parameter name to replacement expression that is
+	// passed. It is built up by the ordered overrides or named
+	// overrides. It is the same for all the instances of an array.
+
+      Module::replace_t replace;
+
+	// Positional parameter overrides are matched to parameter
+	// names by using the param_names list of parameter
+	// names. This is an ordered list of names so the first name
+	// is parameter 0, the second parameter 1, and so on.
+
+      if (overrides_) {
+	    assert(parms_ == 0);
+	    list<perm_string>::const_iterator cur
+		  = mod->param_names.begin();
+	    list<PExpr*>::const_iterator jdx = overrides_->begin();
+	    for (;;) {
+		  if (jdx == overrides_->end())
+			break;
+		  if (cur == mod->param_names.end())
+			break;
+
+		    // No expression means that the parameter is not
+		    // replaced at all.
+		  if (*jdx)
+			replace[*cur] = *jdx;
+
+		  ++ jdx;
+		  ++ cur;
+	    }
+      }
+
+	// Named parameter overrides carry a name with each override
+	// so the mapping into the replace list is much easier.
+      if (parms_) {
+	    assert(overrides_ == 0);
+	    for (unsigned jdx = 0 ;  jdx < nparms_ ;  jdx += 1) {
+		    // No expression means that the parameter is not
+		    // replaced.
+		  if (parms_[jdx].parm)
+			replace[parms_[jdx].name] = parms_[jdx].parm;
+	    }
+      }
+
 	// Run through the module instances, and make scopes out of
 	// them. Also do parameter overrides that are done on the
 	// instantiation line.
@@ -1708,52 +1755,6 @@ void PGModule::elaborate_scope_mod_instances_(Design*des, Module*mod, NetScope*s
 
 	    set_scope_timescale(des, my_scope, mod);
 
-	      // Look for module parameter replacements. The "replace" map
-	      // maps parameter name to replacement expression that is
-	      // passed. It is built up by the ordered overrides or named
-	      // overrides.
-
-	    Module::replace_t replace;
-
-	      // Positional parameter overrides are matched to parameter
-	      // names by using the param_names list of parameter
-	      // names. This is an ordered list of names so the first name
-	      // is parameter 0, the second parameter 1, and so on.
-
-	    if (overrides_) {
-		  assert(parms_ == 0);
-		  list<perm_string>::const_iterator cur
-			= mod->param_names.begin();
-		  list<PExpr*>::const_iterator jdx = overrides_->begin();
-		  for (;;) {
-			if (jdx == overrides_->end())
-			      break;
-			if (cur == mod->param_names.end())
-			      break;
-
-		          // No expression means that the parameter is not
-		          // replaced at all.
-			if (*jdx)
-			      replace[*cur] = *jdx;
-
-			++ jdx;
-			++ cur;
-		  }
-	    }
-
-	      // Named parameter overrides carry a name with each override
-	      // so the mapping into the replace list is much easier.
-	    if (parms_) {
-		  assert(overrides_ == 0);
-		  for (unsigned jdx = 0 ;  jdx < nparms_ ;  jdx += 1) {
-		          // No expression means that the parameter is not
-		          // replaced.
-			if (parms_[jdx].parm)
-			      replace[parms_[jdx].name] = parms_[jdx].parm;
-		  }
-
-	    }
-
 	      // This call actually arranges for the description of the
 	      // module type to process this instance and handle parameters
 	      // and sub-scopes that might occur. Parameters are also
@@ -51,6 +51,9 @@ extern unsigned error_count;
 extern FILE *depend_file;
 extern char dep_mode;
 
+/* If set, the path of every included file is written here. */
+extern FILE *include_list_file;
+
 extern int verbose_flag;
 
 extern int warn_redef;
@@ -97,6 +97,7 @@ int line_direct_flag = 0;
 
 unsigned error_count = 0;
 FILE *depend_file = NULL;
+FILE *include_list_file = NULL;
 
 /* Should we warn about macro redefinitions? */
 int warn_redef = 0;
@@ -249,6 +250,7 @@ int main(int argc, char*argv[])
       FILE*out;
       char*precomp_out_path = 0;
       FILE*precomp_out = NULL;
+      char*include_list_path = 0;
 
 	/* Define preprocessor keywords that I plan to just pass. */
 	/* From 1364-2005 Chapter 19. */
@@ -286,7 +288,7 @@ int main(int argc, char*argv[])
       include_dir[0] = 0;  /* 0 is reserved for the current files path. */
       include_dir[1] = strdup(".");
 
-      while ((opt=getopt(argc, argv, "F:f:K:Lo:p:P:vVW:")) != EOF) switch (opt) {
+      while ((opt=getopt(argc, argv, "F:f:i:K:Lo:p:P:vVW:")) != EOF) switch (opt) {
 
 	  case 'F':
 	    flist_read_flags(optarg);
@@ -300,6 +302,14 @@ int main(int argc, char*argv[])
 	    flist_path = optarg;
 	    break;
 
+	  case 'i':
+	    if (include_list_path) {
+		  fprintf(stderr, "duplicate -i flag.\n");
+	    } else {
+		  include_list_path = optarg;
+	    }
+	    break;
+
 	  case 'K': {
 		char*buf = malloc(strlen(optarg) + 2);
 		buf[0] = '`';
@@ -373,6 +383,7 @@ int main(int argc, char*argv[])
 	    fprintf(stderr, "\nUsage: %s [-v][-L][-F<fil>][-f<fil>] <file>...\n"
 		    "    -F<fil> - Get defines and includes from file\n"
 		    "    -f<fil> - Read the sources listed in the file\n"
+		    "    -i<fil> - Write the paths of included files to <fil>\n"
 		    "    -K<def> - Define a keyword macro that I just pass\n"
 		    "    -L      - Emit line number directives\n"
 		    "    -o<fil> - Send the output to <fil>\n"
@@ -431,10 +442,22 @@ int main(int argc, char*argv[])
 	      }
       }
 
+      if (include_list_path) {
+	    include_list_file = fopen(include_list_path, "w");
+	    if (include_list_file == 0) {
+		  if (out_path) fclose(out);
+		  if (precomp_out) fclose(precomp_out);
+		  if (depend_file) fclose(depend_file);
+		  perror(include_list_path);
+		  exit(1);
+	    }
+      }
+
       if (source_cnt == 0) {
 	    fprintf(stderr, "%s: No input files given.\n", argv[0]);
 	    if (out_path) fclose(out);
 	    if (depend_file) fclose(depend_file);
+	    if (include_list_file) fclose(include_list_file);
 	    if (precomp_out) fclose(precomp_out);
 	    return 1;
       }
@@ -449,12 +472,14 @@ int main(int argc, char*argv[])
       if (yylex()) {
 	    if (out_path) fclose(out);
 	    if (depend_file) fclose(depend_file);
+	    if (include_list_file) fclose(include_list_file);
 	    if (precomp_out) fclose(precomp_out);
 	    return -1;
       }
       destroy_lexor();
 
       if (depend_file) fclose(depend_file);
+      if (include_list_file) fclose(include_list_file);
 
       if (precomp_out) {
 	    dump_precompiled_defines(precomp_out);
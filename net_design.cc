@@ -20,6 +20,7 @@
 # include "config.h"
 
 # include  <iostream>
+# include  <map>
 # include  <set>
 # include  <cstdlib>
 
@@ -175,15 +176,15 @@ NetScope* Design::find_scope(const std::list<hname_t>&path) const
 	    if (path.front() != cur->fullname())
 		  continue;
 
-	    std::list<hname_t> tmp = path;
-	    tmp.pop_front();
+	    std::list<hname_t>::const_iterator key = path.begin();
+	    ++ key;
 
 	    while (cur) {
-		  if (tmp.empty()) return cur;
+		  if (key == path.end()) return cur;
 
-		  cur = cur->child( tmp.front() );
+		  cur = cur->child( *key );
 
-		  tmp.pop_front();
+		  ++ key;
 	    }
       }
 
@@ -230,25 +231,26 @@ static bool is_subroutine(NetScope::TYPE type)
 NetScope* Design::find_scope_(NetScope*scope, const std::list<hname_t>&path,
                               NetScope::TYPE type) const
 {
-      std::list<hname_t> tmp = path;
+      std::list<hname_t>::const_iterator key = path.begin();
 
       do {
-	    hname_t key = tmp.front();
+	    std::list<hname_t>::const_iterator next = key;
+	    ++ next;
 	      /* If we are looking for a module or we are not
 	       * looking at the last path component check for
 	       * a name match (second line). */
 	    if (scope->type() == NetScope::MODULE
-		&& (type == NetScope::MODULE || tmp.size() > 1)
-		&& scope->module_name()==key.peek_name()) {
+		&& (type == NetScope::MODULE || next != path.end())
+		&& scope->module_name()==key->peek_name()) {
 
 		    /* Up references may match module name */
 
 	    } else {
-		  scope = scope->child( key );
+		  scope = scope->child( *key );
 		  if (scope == 0) break;
 	    }
-	    tmp.pop_front();
-      } while (! tmp.empty());
+	    key = next;
+      } while (key != path.end());
 
       return scope;
 }
@@ -387,6 +389,10 @@ void Design::run_defparams()
 
 void NetScope::run_defparams(Design*des)
 {
+	// Only new scopes have defparams, and they are marked.
+      if (! elab_dirty_)
+	    return;
+
       for (map<hname_t,NetScope*>::const_iterator cur = children_.begin()
 		 ; cur != children_.end() ; ++ cur )
 	    cur->second->run_defparams(des);
@@ -481,8 +487,65 @@ void NetScope::run_defparams_later(Design*des)
 	    des->defparams_later.insert(this);
 }
 
+/*
+ * A parameter override is evaluated in the scope that holds the
+ * instance, so all the instances of an instance array evaluate the
+ * very same expressions in the very same scope. No parameter can
+ * change while Design::evaluate_parameters runs, so for the length of
+ * that walk the override values are remembered and copied to the
+ * other instances instead of being elaborated again.
+ */
+struct override_key_s {
+      const PExpr*expr;
+      const NetScope*scope;
+      int lv_width;
+      bool is_annotatable;
+      ivl_variable_type_t type;
+};
+
+static bool operator < (const override_key_s&a, const override_key_s&b)
+{
+      if (a.expr != b.expr) return a.expr < b.expr;
+      if (a.scope != b.scope) return a.scope < b.scope;
+      if (a.lv_width != b.lv_width) return a.lv_width < b.lv_width;
+      if (a.is_annotatable != b.is_annotatable) return b.is_annotatable;
+      return a.type < b.type;
+}
+
+static bool override_values_active = false;
+static map<override_key_s,NetExpr*> override_values;
+
+static NetExpr* elab_parameter_value(Design*des, NetScope*scope,
+				     NetScope*val_scope, PExpr*val_expr,
+				     int lv_width, bool is_annotatable,
+				     ivl_variable_type_t type)
+{
+      if (!override_values_active || val_scope == scope)
+	    return elab_and_eval(des, val_scope, val_expr, lv_width, true,
+				 is_annotatable, type);
+
+      override_key_s key;
+      key.expr = val_expr;
+      key.scope = val_scope;
+      key.lv_width = lv_width;
+      key.is_annotatable = is_annotatable;
+      key.type = type;
+
+      map<override_key_s,NetExpr*>::const_iterator cur = override_values.find(key);
+      if (cur != override_values.end())
+	    return cur->second->dup_expr();
+
+      NetExpr*expr = elab_and_eval(des, val_scope, val_expr, lv_width, true,
+				   is_annotatable, type);
+      if (expr)
+	    override_values[key] = expr->dup_expr();
+      return expr;
+}
+
 void Design::evaluate_parameters()
 {
+      override_values_active = true;
+
       for (map<perm_string,NetScope*>::const_iterator cur = packages_.begin()
 		 ; cur != packages_.end() ; ++ cur) {
 	    cur->second->evaluate_parameters(this);
@@ -492,6 +555,12 @@ void Design::evaluate_parameters()
 		 ; scope != root_scopes_.end() ; ++ scope ) {
 	    (*scope)->evaluate_parameters(this);
       }
+
+      for (map<override_key_s,NetExpr*>::iterator cur = override_values.begin()
+		 ; cur != override_values.end() ; ++ cur)
+	    delete cur->second;
+      override_values.clear();
+      override_values_active = false;
 }
 
 void NetScope::evaluate_parameter_logic_(Design*des, param_ref_t cur)
@@ -540,9 +609,10 @@ void NetScope::evaluate_parameter_logic_(Design*des, param_ref_t cur)
       if (range_flag)
 	    lv_width = (msb >= lsb) ? 1 + msb - lsb : 1 + lsb - msb;
 
-      NetExpr*expr = elab_and_eval(des, val_scope, val_expr, lv_width, true,
-                                   (*cur).second.is_annotatable,
-                                   (*cur).second.type);
+      NetExpr*expr = elab_parameter_value(des, this, val_scope, val_expr,
+                                          lv_width,
+                                          (*cur).second.is_annotatable,
+                                          (*cur).second.type);
       if (! expr)
             return;
 
@@ -660,9 +730,9 @@ void NetScope::evaluate_parameter_real_(Design*des, param_ref_t cur)
       PExpr*val_expr = (*cur).second.val_expr;
       NetScope*val_scope = (*cur).second.val_scope;
 
-      NetExpr*expr = elab_and_eval(des, val_scope, val_expr, -1, true,
-                                   (*cur).second.is_annotatable,
-                                   (*cur).second.type);
+      NetExpr*expr = elab_parameter_value(des, this, val_scope, val_expr, -1,
+                                          (*cur).second.is_annotatable,
+                                          (*cur).second.type);
       if (! expr)
             return;
 
@@ -792,6 +862,12 @@ void NetScope::evaluate_parameter_(Design*des, param_ref_t cur)
 
 void NetScope::evaluate_parameters(Design*des)
 {
+	// A scope that is not marked has no new or overridden
+	// parameters, and neither do its children.
+      if (! elab_dirty_)
+	    return;
+      elab_dirty_ = false;
+
       for (map<hname_t,NetScope*>::const_iterator cur = children_.begin()
 		 ; cur != children_.end() ; ++ cur )
 	    cur->second->evaluate_parameters(des);
@@ -53,39 +53,127 @@ static NetExpr* fix_assign_value(const NetNet*lhs, NetExpr*rhs)
       return rhs;
 }
 
+/*
+ * Add the constant value of a function argument to the key for the
+ * results cache. Return false if the value is not a constant.
+ */
+static bool add_eval_key(string&key, const NetExpr*val)
+{
+      if (const NetEConst*ce = dynamic_cast<const NetEConst*>(val)) {
+	    const verinum&vv = ce->value();
+	    uint64_t head[2] = { vv.len(), vv.has_sign() };
+	    key.append((const char*)head, sizeof head);
+	    for (unsigned idx = 0 ; idx < vv.nwords() ; idx += 1) {
+		  uint64_t word[2] = { vv.get_aword(idx), vv.get_bword(idx) };
+		  key.append((const char*)word, sizeof word);
+	    }
+	    return true;
+      }
+
+      if (const NetECReal*re = dynamic_cast<const NetECReal*>(val)) {
+	    double dv = re->value().as_double();
+	    key.append(1, 'r');
+	    key.append((const char*)&dv, sizeof dv);
+	    return true;
+      }
+
+      return false;
+}
+
+LocalFrame::LocalFrame(const void*owner, unsigned nslots)
+: owner_(owner), slots_(nslots)
+{
+      for (unsigned idx = 0 ; idx < nslots ; idx += 1) {
+	    slots_[idx].nwords = 0;
+	    slots_[idx].value  = 0;
+      }
+}
+
+static void release_local(LocalVar&var)
+{
+      if (var.nwords > 0) {
+	    for (int idx = 0 ; idx < var.nwords ; idx += 1)
+		  delete var.array[idx];
+	    delete [] var.array;
+      } else {
+	    delete var.value;
+      }
+      var.nwords = 0;
+      var.value  = 0;
+}
+
+LocalFrame::~LocalFrame()
+{
+      for (unsigned idx = 0 ; idx < slots_.size() ; idx += 1)
+	    release_local(slots_[idx]);
+}
+
+LocalVar* LocalFrame::reset(const NetNet*net, unsigned nwords)
+{
+      LocalVar*var = find(net);
+      if (var == 0)
+	    return 0;
+
+      release_local(*var);
+      var->nwords = nwords;
+      if (nwords > 0) {
+	    var->array = new NetExpr*[nwords];
+	    for (unsigned idx = 0 ; idx < nwords ; idx += 1)
+		  var->array[idx] = 0;
+      }
+      return var;
+}
+
 NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<NetExpr*>&args) const
 {
-	// Make the context map.
-      map<perm_string,LocalVar>::iterator ptr;
-      map<perm_string,LocalVar>context_map;
+      string key;
+      bool key_flag = true;
 
       if (debug_eval_tree) {
 	    cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
 		 << "Evaluate function " << scope()->basename() << endl;
       }
 
-	// Put the return value into the map...
-      LocalVar&return_var = context_map[scope()->basename()];
-      return_var.nwords = 0;
-      return_var.value  = 0;
+	// Give the variables of the function (and of its named
+	// blocks) their slots. This is done once, the first time the
+	// function is evaluated.
+      if (eval_slots_ < 0)
+	    eval_slots_ = scope()->evaluate_function_slots(this, 0);
 
-	// Load the input ports into the map...
+	// Make the context frame. The return value, if any, starts
+	// out as nil.
+      LocalFrame context_map (this, eval_slots_);
+
+	// Load the input ports into the frame...
       ivl_assert(loc, port_count() == args.size());
       for (size_t idx = 0 ; idx < port_count() ; idx += 1) {
 	    const NetNet*pnet = port(idx);
-	    perm_string aname = pnet->name();
-	    LocalVar&input_var = context_map[aname];
-	    input_var.nwords = 0;
-	    input_var.value  = fix_assign_value(pnet, args[idx]);
+	    LocalVar*input_var = context_map.find(pnet);
+	    ivl_assert(loc, input_var);
+	    input_var->value = fix_assign_value(pnet, args[idx]);
+	    if (key_flag)
+		  key_flag = add_eval_key(key, input_var->value);
+
+	    if (debug_eval_tree) {
+		  cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
+		       << "   input " << pnet->name() << " = " << *args[idx] << endl;
+	    }
+      }
 
+	// System tasks are ignored and the locals start out fresh, so
+	// the result only depends on the arguments. If these arguments
+	// have been seen before, reuse that result.
+      map<string,NetExpr*>::const_iterator hit;
+      if (key_flag && (hit = eval_cache_.find(key)) != eval_cache_.end()) {
 	    if (debug_eval_tree) {
 		  cerr << loc.get_fileline() << ": NetFuncDef::evaluate_function: "
-		       << "   input " << aname << " = " << *args[idx] << endl;
+		       << "Reuse result " << *hit->second << endl;
 	    }
+	    return hit->second->dup_expr();
       }
 
-	// Ask the scope to collect definitions for local values. This
-	// fills in the context_map with local variables held by the scope.
+	// Ask the scope to set up the local values. This gives the
+	// local variables held by the scope fresh values.
       scope()->evaluate_function_find_locals(loc, context_map);
 
 	// Execute any variable initialization statements.
@@ -108,24 +196,13 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
 		 << "Cannot evaluate " << scope_path(scope()) << "." << endl;
       }
 
-	// Extract the result...
-      ptr = context_map.find(scope()->basename());
-      NetExpr*res = ptr->second.value;
-      context_map.erase(ptr);
-
-	// Cleanup the rest of the context.
-      for (ptr = context_map.begin() ; ptr != context_map.end() ; ++ptr) {
-
-	    unsigned nwords = ptr->second.nwords;
-	    if (nwords > 0) {
-		  NetExpr**array = ptr->second.array;
-		  for (unsigned idx = 0 ; idx < nwords ; idx += 1) {
-			delete array[idx];
-		  }
-		  delete [] ptr->second.array;
-	    } else {
-		  delete ptr->second.value;
-	    }
+	// Extract the result. The rest of the context is released
+	// with the frame.
+      NetExpr*res = 0;
+      if (LocalVar*return_var = result_sig_? context_map.find(result_sig_) : 0) {
+	    ivl_assert(loc, return_var->nwords == 0);
+	    res = return_var->value;
+	    return_var->value = 0;
       }
 
       if (disable) {
@@ -147,6 +224,8 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
 		  else cerr << "<nil>";
 		  cerr << endl;
 	    }
+	    if (res && key_flag && eval_cache_.size() < EVAL_CACHE_MAX)
+		  eval_cache_[key] = res->dup_expr();
 	    return res;
       }
 
@@ -159,8 +238,24 @@ NetExpr* NetFuncDef::evaluate_function(const LineInfo&loc, const std::vector<Net
       return 0;
 }
 
+unsigned NetScope::evaluate_function_slots(const void*owner, unsigned next) const
+{
+      for (map<perm_string,NetNet*>::const_iterator cur = signals_map_.begin()
+		 ; cur != signals_map_.end() ; ++cur) {
+	    cur->second->eval_slot(owner, next);
+	    next += 1;
+      }
+
+      for (map<hname_t,NetScope*>::const_iterator cur = children_.begin()
+		 ; cur != children_.end() ; ++cur) {
+	    next = cur->second->evaluate_function_slots(owner, next);
+      }
+
+      return next;
+}
+
 void NetScope::evaluate_function_find_locals(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       for (map<perm_string,NetNet*>::const_iterator cur = signals_map_.begin()
 		 ; cur != signals_map_.end() ; ++cur) {
@@ -174,18 +269,8 @@ void NetScope::evaluate_function_find_locals(const LineInfo&loc,
 	    if (tmp->unpacked_dimensions() > 0)
 		  nwords = tmp->unpacked_count();
 
-	    LocalVar&local_var = context_map[tmp->name()];
-	    local_var.nwords = nwords;
-
-	    if (nwords > 0) {
-		  NetExpr**array = new NetExpr*[nwords];
-		  for (unsigned idx = 0 ; idx < nwords ; idx += 1) {
-			array[idx] = 0;
-		  }
-		  local_var.array = array;
-	    } else {
-		  local_var.value = 0;
-	    }
+	    LocalVar*local_var = context_map.reset(tmp, nwords);
+	    ivl_assert(loc, local_var);
 
 	    if (debug_eval_tree) {
 		  cerr << loc.get_fileline() << ": debug: "
@@ -196,7 +281,7 @@ void NetScope::evaluate_function_find_locals(const LineInfo&loc,
 }
 
 NetExpr* NetExpr::evaluate_function(const LineInfo&,
-				    map<perm_string,LocalVar>&) const
+				    LocalFrame&) const
 {
       cerr << get_fileline() << ": sorry: I don't know how to evaluate this expression at compile time." << endl;
       cerr << get_fileline() << ":      : Expression type:" << typeid(*this).name() << endl;
@@ -205,7 +290,7 @@ NetExpr* NetExpr::evaluate_function(const LineInfo&,
 }
 
 bool NetProc::evaluate_function(const LineInfo&,
-				map<perm_string,LocalVar>&) const
+				LocalFrame&) const
 {
       cerr << get_fileline() << ": sorry: I don't know how to evaluate this statement at compile time." << endl;
       cerr << get_fileline() << ":      : Statement type:" << typeid(*this).name() << endl;
@@ -306,17 +391,11 @@ void NetAssign::eval_func_lval_op_(const LineInfo&loc,
 }
 
 bool NetAssign::eval_func_lval_(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map,
+				LocalFrame&context_map,
 				const NetAssign_*lval, NetExpr*rval_result) const
 {
-      map<perm_string,LocalVar>::iterator ptr = context_map.find(lval->name());
-      ivl_assert(*this, ptr != context_map.end());
-
-      LocalVar*var = & ptr->second;
-      while (var->nwords == -1) {
-	    assert(var->ref);
-	    var = var->ref;
-      }
+      LocalVar*var = context_map.find(lval->sig());
+      ivl_assert(*this, var);
 
       NetExpr*old_lval;
       int word = 0;
@@ -380,8 +459,7 @@ bool NetAssign::eval_func_lval_(const LineInfo&loc,
 	    } else {
 		  lpart = cast_to_width(rval_v, lval->lwidth());
 	    }
-	    for (unsigned idx = 0 ; idx < lpart.len() ; idx += 1)
-		  lval_v.set(idx+base, lpart[idx]);
+	    lval_v.set(base, lpart);
 
 	    delete base_result;
 	    delete rval_result;
@@ -435,7 +513,7 @@ bool NetAssign::eval_func_lval_(const LineInfo&loc,
 }
 
 bool NetAssign::evaluate_function(const LineInfo&loc,
-				  map<perm_string,LocalVar>&context_map) const
+				  LocalFrame&context_map) const
 {
 	// Evaluate the r-value expression.
       NetExpr*rval_result = rval()->evaluate_function(loc, context_map);
@@ -484,41 +562,20 @@ bool NetAssign::evaluate_function(const LineInfo&loc,
  * evaluating the statements in order.
  */
 bool NetBlock::evaluate_function(const LineInfo&loc,
-				 map<perm_string,LocalVar>&context_map) const
+				 LocalFrame&context_map) const
 {
       if (last_ == 0) return true;
 
-	// If we need to make a local scope, then this context map
-	// will be filled in and used for statements within this block.
-      map<perm_string,LocalVar>local_context_map;
-      bool use_local_context_map = false;
-
+	// The locals of a block scope have their own slots in the
+	// frame. Give them fresh values each time the block is entered.
       if (subscope_!=0) {
-	      // First, copy the containing scope symbols into the new
-	      // scope as references.
-	    for (map<perm_string,LocalVar>::iterator cur = context_map.begin()
-		       ; cur != context_map.end() ; ++cur) {
-		  LocalVar&cur_var = local_context_map[cur->first];
-		  cur_var.nwords = -1;
-		  if (cur->second.nwords == -1)
-			cur_var.ref = cur->second.ref;
-		  else
-			cur_var.ref = &cur->second;
-	    }
-
-	      // Now collect the new locals.
-	    subscope_->evaluate_function_find_locals(loc, local_context_map);
-	    use_local_context_map = true;
+	    subscope_->evaluate_function_find_locals(loc, context_map);
 
 	      // Execute any variable initialization statements.
 	    if (const NetProc*init_proc = subscope_->var_init())
-		  init_proc->evaluate_function(loc, local_context_map);
+		  init_proc->evaluate_function(loc, context_map);
       }
 
-	// Now use the local context map if there is any local
-	// context, or the containing context map.
-      map<perm_string,LocalVar>&use_context_map = use_local_context_map? local_context_map : context_map;
-
       bool flag = true;
       NetProc*cur = last_;
       do {
@@ -529,7 +586,7 @@ bool NetBlock::evaluate_function(const LineInfo&loc,
 		       << ") at " << cur->get_fileline() << "." << endl;
 	    }
 
-	    bool cur_flag = cur->evaluate_function(loc, use_context_map);
+	    bool cur_flag = cur->evaluate_function(loc, context_map);
 	    flag = flag && cur_flag;
       } while (cur != last_ && !disable);
 
@@ -546,7 +603,7 @@ bool NetBlock::evaluate_function(const LineInfo&loc,
 }
 
 bool NetCase::evaluate_function_vect_(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       NetExpr*case_expr = expr_->evaluate_function(loc, context_map);
       if (case_expr == 0)
@@ -608,7 +665,7 @@ bool NetCase::evaluate_function_vect_(const LineInfo&loc,
 }
 
 bool NetCase::evaluate_function_real_(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       NetExpr*case_expr = expr_->evaluate_function(loc, context_map);
       if (case_expr == 0)
@@ -652,7 +709,7 @@ bool NetCase::evaluate_function_real_(const LineInfo&loc,
 }
 
 bool NetCase::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       if (expr_->expr_type() == IVL_VT_REAL)
 	    return evaluate_function_real_(loc, context_map);
@@ -661,7 +718,7 @@ bool NetCase::evaluate_function(const LineInfo&loc,
 }
 
 bool NetCondit::evaluate_function(const LineInfo&loc,
-				  map<perm_string,LocalVar>&context_map) const
+				  LocalFrame&context_map) const
 {
       NetExpr*cond = expr_->evaluate_function(loc, context_map);
       if (cond == 0) {
@@ -695,7 +752,7 @@ bool NetCondit::evaluate_function(const LineInfo&loc,
 }
 
 bool NetDisable::evaluate_function(const LineInfo&,
-				   map<perm_string,LocalVar>&) const
+				   LocalFrame&) const
 {
       disable = target_;
 
@@ -708,7 +765,7 @@ bool NetDisable::evaluate_function(const LineInfo&,
 }
 
 bool NetDoWhile::evaluate_function(const LineInfo&loc,
-				   map<perm_string,LocalVar>&context_map) const
+				   LocalFrame&context_map) const
 {
       bool flag = true;
 
@@ -751,7 +808,7 @@ bool NetDoWhile::evaluate_function(const LineInfo&loc,
 }
 
 bool NetForever::evaluate_function(const LineInfo&loc,
-				   map<perm_string,LocalVar>&context_map) const
+				   LocalFrame&context_map) const
 {
       bool flag = true;
 
@@ -777,13 +834,13 @@ bool NetForever::evaluate_function(const LineInfo&loc,
  * to do this directly.
  */
 bool NetForLoop::evaluate_function(const LineInfo&loc,
-				   map<perm_string,LocalVar>&context_map) const
+				   LocalFrame&context_map) const
 {
       return as_block_->evaluate_function(loc, context_map);
 }
 
 bool NetRepeat::evaluate_function(const LineInfo&loc,
-				  map<perm_string,LocalVar>&context_map) const
+				  LocalFrame&context_map) const
 {
       bool flag = true;
 
@@ -817,14 +874,14 @@ bool NetRepeat::evaluate_function(const LineInfo&loc,
 }
 
 bool NetSTask::evaluate_function(const LineInfo&,
-				 map<perm_string,LocalVar>&) const
+				 LocalFrame&) const
 {
 	// system tasks within a constant function are ignored
       return true;
 }
 
 bool NetWhile::evaluate_function(const LineInfo&loc,
-				 map<perm_string,LocalVar>&context_map) const
+				 LocalFrame&context_map) const
 {
       bool flag = true;
 
@@ -868,7 +925,7 @@ bool NetWhile::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEBinary::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       NetExpr*lval = left_->evaluate_function(loc, context_map);
       NetExpr*rval = right_->evaluate_function(loc, context_map);
@@ -886,7 +943,7 @@ NetExpr* NetEBinary::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEConcat::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       vector<NetExpr*>vals(parms_.size());
       unsigned gap = 0;
@@ -913,7 +970,7 @@ NetExpr* NetEConcat::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEConst::evaluate_function(const LineInfo&,
-				      map<perm_string,LocalVar>&) const
+				      LocalFrame&) const
 {
       NetEConst*res = new NetEConst(value_);
       res->set_line(*this);
@@ -921,7 +978,7 @@ NetExpr* NetEConst::evaluate_function(const LineInfo&,
 }
 
 NetExpr* NetECReal::evaluate_function(const LineInfo&,
-				      map<perm_string,LocalVar>&) const
+				      LocalFrame&) const
 {
       NetECReal*res = new NetECReal(value_);
       res->set_line(*this);
@@ -929,7 +986,7 @@ NetExpr* NetECReal::evaluate_function(const LineInfo&,
 }
 
 NetExpr* NetESelect::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       NetExpr*sub_exp = expr_->evaluate_function(loc, context_map);
       ivl_assert(loc, sub_exp);
@@ -964,22 +1021,15 @@ NetExpr* NetESelect::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetESignal::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
-      map<perm_string,LocalVar>::iterator ptr = context_map.find(name());
-      if (ptr == context_map.end()) {
+      LocalVar*var = context_map.find(sig());
+      if (var == 0) {
 	    cerr << get_fileline() << ": error: Cannot evaluate " << name()
 		 << " in this context." << endl;
 	    return 0;
       }
 
-	// Follow indirect references to the actual variable.
-      LocalVar*var = & ptr->second;
-      while (var->nwords == -1) {
-	    assert(var->ref);
-	    var = var->ref;
-      }
-
       NetExpr*value = 0;
       if (var->nwords > 0) {
 	    ivl_assert(loc, word_);
@@ -1016,7 +1066,7 @@ NetExpr* NetESignal::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetETernary::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       auto_ptr<NetExpr> cval (cond_->evaluate_function(loc, context_map));
 
@@ -1043,7 +1093,7 @@ NetExpr* NetETernary::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEUnary::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       NetExpr*val = expr_->evaluate_function(loc, context_map);
       if (val == 0) return 0;
@@ -1054,7 +1104,7 @@ NetExpr* NetEUnary::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetESFunc::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       ID id = built_in_id_();
       ivl_assert(*this, id != NOT_BUILT_IN);
@@ -1084,7 +1134,7 @@ NetExpr* NetESFunc::evaluate_function(const LineInfo&loc,
 }
 
 NetExpr* NetEUFunc::evaluate_function(const LineInfo&loc,
-				map<perm_string,LocalVar>&context_map) const
+				LocalFrame&context_map) const
 {
       NetFuncDef*def = func_->func_def();
       ivl_assert(*this, def);
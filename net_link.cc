@@ -29,6 +29,13 @@
 # include  <cstdlib>
 # include  "ivl_alloc.h"
 
+/*
+ * This counts the times that the links of one Nexus were moved to
+ * another and the old Nexus deleted. The NexusSet index is keyed on
+ * the Nexus pointer, so it is rebuilt if this changes.
+ */
+static unsigned long nexus_merge_count = 0;
+
 void Nexus::connect(Link&r)
 {
       Nexus*r_nexus = r.next_? r.find_nexus_() : 0;
@@ -53,6 +60,7 @@ void Nexus::connect(Link&r)
 		  list_->nexus_ = this;
 		  r_nexus->list_ = 0;
 		  delete r_nexus;
+		  nexus_merge_count += 1;
 	    }
 	    return;
       }
@@ -86,6 +94,7 @@ void Nexus::connect(Link&r)
 
       r_nexus->list_ = 0;
       delete r_nexus;
+      nexus_merge_count += 1;
 }
 
 void connect(Link&l, Link&r)
@@ -268,6 +277,7 @@ Nexus::Nexus(Link&that)
 	    tmp->list_ = 0;
 	    tmp->name_ = 0;
 	    delete tmp;
+	    nexus_merge_count += 1;
       }
 }
 
@@ -562,6 +572,7 @@ const char* Nexus::name() const
 
 
 NexusSet::NexusSet()
+: index_merge_count_(nexus_merge_count)
 {
 }
 
@@ -576,17 +587,54 @@ size_t NexusSet::size() const
       return items_.size();
 }
 
+bool NexusSet::index_key_t::operator < (const index_key_t&that) const
+{
+      if (nex != that.nex)
+	    return nex < that.nex;
+      if (base != that.base)
+	    return base < that.base;
+      return wid < that.wid;
+}
+
+NexusSet::index_key_t NexusSet::index_key_(const NexusSet::elem_t&that)
+{
+      index_key_t key;
+      key.nex = that.lnk.nexus();
+      key.base = that.base;
+      key.wid = that.wid;
+      return key;
+}
+
+/*
+ * If any nexus was merged into another since the index was made, the
+ * Nexus pointers in the keys may be stale, so make it again. If items
+ * became equal by the merge, the index finds the first of them, as
+ * the linear search did.
+ */
+void NexusSet::build_index_() const
+{
+      index_.clear();
+      for (size_t idx = 0 ; idx < items_.size() ; idx += 1) {
+	    if (items_[idx])
+		  index_.insert(make_pair(index_key_(*items_[idx]), idx));
+      }
+
+      index_merge_count_ = nexus_merge_count;
+}
+
+void NexusSet::check_index_() const
+{
+      if (index_merge_count_ != nexus_merge_count)
+	    build_index_();
+}
+
 void NexusSet::add(Nexus*that, unsigned base, unsigned wid)
 {
       assert(that);
       elem_t*cur = new elem_t(that, base, wid);
 
-      if (items_.size() == 0) {
-	    items_.resize(1);
-	    items_[0] = cur;
-	    return;
-      }
-
+	// Making the element may itself have merged nexa, so check
+	// the index after and not before.
       unsigned ptr = bsearch_(*cur);
       if (ptr < items_.size()) {
 	    delete cur;
@@ -595,6 +643,7 @@ void NexusSet::add(Nexus*that, unsigned base, unsigned wid)
 
       assert(ptr == items_.size());
 
+      index_[index_key_(*cur)] = items_.size();
       items_.push_back(cur);
 }
 
@@ -604,32 +653,39 @@ void NexusSet::add(NexusSet&that)
 	    add(that.items_[idx]->lnk.nexus(), that.items_[idx]->base, that.items_[idx]->wid);
 }
 
-void NexusSet::rem_(const NexusSet::elem_t*that)
+bool NexusSet::rem_(const NexusSet::elem_t*that)
 {
       if (items_.empty())
-	    return;
+	    return false;
 
       unsigned ptr = bsearch_(*that);
       if (ptr >= items_.size())
-	    return;
-
-      if (items_.size() == 1) {
-	    delete items_[0];
-	    items_.clear();
-	    return;
-      }
+	    return false;
 
+      index_.erase(index_key_(*items_[ptr]));
       delete items_[ptr];
-      for (unsigned idx = ptr ;  idx < (items_.size()-1) ;  idx += 1)
-	    items_[idx] = items_[idx+1];
-
-      items_.pop_back();
+      items_[ptr] = 0;
+      return true;
 }
 
 void NexusSet::rem(const NexusSet&that)
 {
-      for (size_t idx = 0 ;  idx < that.items_.size() ;  idx += 1)
-	    rem_(that.items_[idx]);
+      bool removed = false;
+      for (size_t idx = 0 ;  idx < that.items_.size() ;  idx += 1) {
+	    if (rem_(that.items_[idx]))
+		  removed = true;
+      }
+
+      if (! removed)
+	    return;
+
+      size_t out = 0;
+      for (size_t idx = 0 ;  idx < items_.size() ;  idx += 1) {
+	    if (items_[idx])
+		  items_[out++] = items_[idx];
+      }
+      items_.resize(out);
+      build_index_();
 }
 
 unsigned NexusSet::find_nexus(const NexusSet::elem_t&that) const
@@ -645,12 +701,16 @@ NexusSet::elem_t& NexusSet::at (unsigned idx)
 
 size_t NexusSet::bsearch_(const NexusSet::elem_t&that) const
 {
-      for (unsigned idx = 0 ;  idx < items_.size() ;  idx += 1) {
-	    if (*items_[idx] == that)
-		  return idx;
-      }
+      if (! that.lnk.is_linked())
+	    return items_.size();
 
-      return items_.size();
+      check_index_();
+
+      map<index_key_t,size_t>::const_iterator cur = index_.find(index_key_(that));
+      if (cur == index_.end())
+	    return items_.size();
+
+      return cur->second;
 }
 
 bool NexusSet::elem_t::contains(const struct elem_t&that) const
@@ -665,10 +725,29 @@ bool NexusSet::elem_t::contains(const struct elem_t&that) const
       return true;
 }
 
+/*
+ * The items for a nexus are together in the index, in order of their
+ * base, so only the ones that start at or before that part need to
+ * be looked at.
+ */
 bool NexusSet::contains_(const NexusSet::elem_t&that) const
 {
-      for (unsigned idx = 0 ; idx < items_.size() ; idx += 1) {
-	    if (items_[idx]->contains(that))
+      if (! that.lnk.is_linked())
+	    return false;
+
+      check_index_();
+
+      index_key_t key = index_key_(that);
+      key.base = 0;
+      key.wid = 0;
+
+      map<index_key_t,size_t>::const_iterator cur = index_.lower_bound(key);
+      for ( ; cur != index_.end() ; ++ cur) {
+	    if (cur->first.nex != key.nex)
+		  break;
+	    if (cur->first.base > that.base)
+		  break;
+	    if (items_[cur->second]->contains(that))
 		  return true;
       }
       return false;
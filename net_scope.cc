@@ -136,6 +136,7 @@ NetScope::NetScope(NetScope*up, const hname_t&n, NetScope::TYPE t, NetScope*in_u
 	    time_from_timescale_ = up->time_from_timescale();
 	      // Need to check for duplicate names?
 	    up_->children_[name_] = this;
+	    up_->index_child_(this);
 	    if (unit_ == 0)
 		  unit_ = up_->unit_;
       } else {
@@ -166,11 +167,15 @@ NetScope::NetScope(NetScope*up, const hname_t&n, NetScope::TYPE t, NetScope*in_u
       }
       func_pform_ = 0;
       elab_stage_ = 1;
+      elab_dirty_ = false;
       lineno_ = 0;
       def_lineno_ = 0;
       genvar_tmp_val = 0;
+      loop_index_tmp = 0;
       tie_hi_ = 0;
       tie_lo_ = 0;
+
+      mark_elab_dirty();
 }
 
 NetScope::~NetScope()
@@ -245,6 +250,7 @@ void NetScope::set_parameter(perm_string key, bool is_annotatable,
       ref.range = range_list;
       ref.val = 0;
       ref.set_line(file_line);
+      mark_elab_dirty();
 }
 
 /*
@@ -293,9 +299,11 @@ bool NetScope::auto_name(const char*prefix, char pad, const char* suffix)
 	    if (!up_->child(new_name)) {
 		    // Ah, this name is unique. Rename myself, and
 		    // change my name in the parent scope.
+		  up_->unindex_child_(this);
 		  name_ = new_name;
 		  up_->children_.erase(self);
 		  up_->children_[name_] = this;
+		  up_->index_child_(this);
 		  return true;
 	    }
 
@@ -320,9 +328,16 @@ bool NetScope::replace_parameter(perm_string key, PExpr*val, NetScope*scope)
 
       ref.val_expr = val;
       ref.val_scope = scope;
+      mark_elab_dirty();
       return true;
 }
 
+void NetScope::mark_elab_dirty()
+{
+      for (NetScope*cur = this ; cur && !cur->elab_dirty_ ; cur = cur->up_)
+	    cur->elab_dirty_ = true;
+}
+
 bool NetScope::make_parameter_unannotatable(perm_string key)
 {
       bool flag = false;
@@ -678,26 +693,79 @@ netclass_t*NetScope::find_class(perm_string name)
       return 0;
 }
 
+static size_t child_hash(const hname_t&name)
+{
+      size_t hash = 5381;
+      for (const char*cp = name.peek_name().str() ; cp && *cp ; cp += 1)
+	    hash = hash * 33 + (unsigned char)*cp;
+
+      for (size_t idx = 0 ; idx < name.has_numbers() ; idx += 1)
+	    hash = hash * 33 + (unsigned)name.peek_number(idx);
+
+      return hash;
+}
+
+/*
+ * Add the child scope to the hash index. A child with the same name
+ * replaces an existing one in children_, so it replaces it in the
+ * index as well.
+ */
+void NetScope::index_child_(NetScope*that)
+{
+      size_t hash = child_hash(that->name_);
+      typedef multimap<size_t,NetScope*>::iterator index_iter_t;
+      pair<index_iter_t,index_iter_t> range = child_index_.equal_range(hash);
+      for (index_iter_t cur = range.first ; cur != range.second ; ++ cur) {
+	    if (cur->second->name_ == that->name_) {
+		  cur->second = that;
+		  return;
+	    }
+      }
+
+      child_index_.insert(make_pair(hash, that));
+}
+
+void NetScope::unindex_child_(const NetScope*that)
+{
+      typedef multimap<size_t,NetScope*>::iterator index_iter_t;
+      pair<index_iter_t,index_iter_t> range
+	    = child_index_.equal_range(child_hash(that->name_));
+      for (index_iter_t cur = range.first ; cur != range.second ; ++ cur) {
+	    if (cur->second == that) {
+		  child_index_.erase(cur);
+		  return;
+	    }
+      }
+}
+
 /*
  * This method locates a child scope by name. The name is the simple
  * name of the child, no hierarchy is searched.
  */
 NetScope* NetScope::child(const hname_t&name)
 {
-      map<hname_t,NetScope*>::iterator cur = children_.find(name);
-      if (cur == children_.end())
-	    return 0;
-      else
-	    return cur->second;
+      typedef multimap<size_t,NetScope*>::iterator index_iter_t;
+      pair<index_iter_t,index_iter_t> range
+	    = child_index_.equal_range(child_hash(name));
+      for (index_iter_t cur = range.first ; cur != range.second ; ++ cur) {
+	    if (cur->second->name_ == name)
+		  return cur->second;
+      }
+
+      return 0;
 }
 
 const NetScope* NetScope::child(const hname_t&name) const
 {
-      map<hname_t,NetScope*>::const_iterator cur = children_.find(name);
-      if (cur == children_.end())
-	    return 0;
-      else
-	    return cur->second;
+      typedef multimap<size_t,NetScope*>::const_iterator index_iter_t;
+      pair<index_iter_t,index_iter_t> range
+	    = child_index_.equal_range(child_hash(name));
+      for (index_iter_t cur = range.first ; cur != range.second ; ++ cur) {
+	    if (cur->second->name_ == name)
+		  return cur->second;
+      }
+
+      return 0;
 }
 
 /* Helper function to see if the given scope is defined in a class and if
@@ -571,7 +571,7 @@ NetNet::NetNet(NetScope*s, perm_string n, Type t,
     type_(t), port_type_(NOT_A_PORT),
     local_flag_(false), net_type_(use_net_type),
     discipline_(0), unpacked_dims_(unpacked.size()),
-    eref_count_(0), lref_count_(0)
+    eref_count_(0), lref_count_(0), eval_owner_(0), eval_slot_(0)
 {
       calculate_slice_widths_from_packed_dims_();
       size_t idx = 0;
@@ -602,7 +602,7 @@ NetNet::NetNet(NetScope*s, perm_string n, Type t, netstruct_t*ty)
     type_(t), port_type_(NOT_A_PORT),
     local_flag_(false), net_type_(ty),
     discipline_(0),
-    eref_count_(0), lref_count_(0)
+    eref_count_(0), lref_count_(0), eval_owner_(0), eval_slot_(0)
 {
 	//XXXX packed_dims_.push_back(netrange_t(calculate_count(ty)-1, 0));
       calculate_slice_widths_from_packed_dims_();
@@ -617,7 +617,7 @@ NetNet::NetNet(NetScope*s, perm_string n, Type t, netdarray_t*ty)
     type_(t), port_type_(NOT_A_PORT),
     local_flag_(false), net_type_(ty),
     discipline_(0),
-    eref_count_(0), lref_count_(0)
+    eref_count_(0), lref_count_(0), eval_owner_(0), eval_slot_(0)
 {
       initialize_dir_();
 
@@ -629,7 +629,7 @@ NetNet::NetNet(NetScope*s, perm_string n, Type t, netvector_t*ty)
     type_(t), port_type_(NOT_A_PORT),
     local_flag_(false), net_type_(ty),
     discipline_(0),
-    eref_count_(0), lref_count_(0)
+    eref_count_(0), lref_count_(0), eval_owner_(0), eval_slot_(0)
 {
       calculate_slice_widths_from_packed_dims_();
 
@@ -2138,12 +2138,15 @@ const NetProc* NetBaseDef::proc() const
 
 NetFuncDef::NetFuncDef(NetScope*s, NetNet*result, const vector<NetNet*>&po,
 		       const vector<NetExpr*>&pd)
-: NetBaseDef(s, po, pd), result_sig_(result)
+: NetBaseDef(s, po, pd), result_sig_(result), eval_slots_(-1)
 {
 }
 
 NetFuncDef::~NetFuncDef()
 {
+      for (map<string,NetExpr*>::iterator cur = eval_cache_.begin()
+		 ; cur != eval_cache_.end() ; ++cur)
+	    delete cur->second;
 }
 
 const NetNet* NetFuncDef::return_sig() const
@@ -491,8 +491,27 @@ class NexusSet {
 	// NexSet items are canonical part selects of vectors.
       std::vector<struct elem_t*> items_;
 
+	// The index maps the (nexus, base, wid) of each item to its
+	// position in items_, so that lookups do not scan the whole
+	// set. It is keyed on the Nexus pointer, so it is rebuilt if
+	// any nexus has been merged into another since it was made.
+      struct index_key_t {
+	    const Nexus*nex;
+	    unsigned base;
+	    unsigned wid;
+	    bool operator < (const index_key_t&that) const;
+      };
+      mutable std::map<index_key_t,size_t> index_;
+      mutable unsigned long index_merge_count_;
+
+      static index_key_t index_key_(const elem_t&that);
+      void build_index_() const;
+      void check_index_() const;
+
       size_t bsearch_(const struct elem_t&that) const;
-      void rem_(const struct elem_t*that);
+	// rem_ leaves a null item in place of the one it removes, and
+	// rem compacts the items and the index once when it is done.
+      bool rem_(const struct elem_t*that);
       bool contains_(const elem_t&that) const;
 
     private: // not implemented
@@ -828,6 +847,18 @@ class NetNet  : public NetObj, public PortType {
 
       vector<class NetDelaySrc*> delay_paths_;
       int       port_index_;
+
+    public:
+	// Constant function evaluation keeps the value of this
+	// signal in the slot of a LocalFrame. See LocalFrame.
+      void eval_slot(const void*owner, unsigned slot) const
+      { eval_owner_ = owner; eval_slot_ = slot; }
+      const void*eval_owner() const { return eval_owner_; }
+      unsigned eval_slot() const { return eval_slot_; }
+
+    private:
+      mutable const void*eval_owner_;
+      mutable unsigned eval_slot_;
 };
 
 /*
@@ -835,14 +866,53 @@ class NetNet  : public NetObj, public PortType {
  * evaluating constant user functions.
  */
 struct LocalVar {
-      int nwords;  // zero for a simple variable, -1 for reference
+      int nwords;  // zero for a simple variable
       union {
 	    NetExpr*  value;  // a simple variable
 	    NetExpr** array;  // an array variable
-	    LocalVar* ref;    // A reference to a previous scope
       };
 };
 
+/*
+ * A LocalFrame holds the local variables of one evaluation of a
+ * constant function. Each variable of the function, including the
+ * variables of its named blocks, is given a slot number once (see
+ * NetFuncDef::evaluate_function) and the NetNet remembers it, so that
+ * reading or writing a variable is an index into the frame and not a
+ * lookup by name. The owner tags the slot numbers so that a NetNet
+ * that was not given a slot for this kind of frame is not found.
+ */
+class LocalFrame {
+    public:
+      LocalFrame(const void*owner, unsigned nslots);
+      ~LocalFrame();
+
+	// Return the variable for the signal, or nil if the signal
+	// has no slot in this frame.
+      inline LocalVar* find(const NetNet*net);
+
+	// Release the current value of the signal, and make it a
+	// fresh variable. If nwords>0, it is an array of that many
+	// words. Return nil if the signal has no slot in this frame.
+      LocalVar* reset(const NetNet*net, unsigned nwords);
+
+    private:
+      const void*owner_;
+      std::vector<LocalVar> slots_;
+
+    private: // not implemented
+      LocalFrame(const LocalFrame&);
+      LocalFrame& operator= (const LocalFrame&);
+};
+
+inline LocalVar* LocalFrame::find(const NetNet*net)
+{
+      unsigned slot = net->eval_slot();
+      if (net->eval_owner() != owner_ || slot >= slots_.size())
+	    return 0;
+      return &slots_[slot];
+}
+
 class NetBaseDef {
     public:
       NetBaseDef(NetScope*n, const vector<NetNet*>&po,
@@ -1047,10 +1117,13 @@ class NetScope : public Definitions, public Attrib {
       NetTaskDef* task_def();
       NetFuncDef* func_def();
 
-	// This is used by the evaluate_function setup to collect
-	// local variables from the scope.
+	// These are used by the evaluate_function setup. The first
+	// gives the signals of this scope and its children slots
+	// starting at next, and returns the next free slot. The
+	// second gives the local variables of the scope fresh values.
+      unsigned evaluate_function_slots(const void*owner, unsigned next) const;
       void evaluate_function_find_locals(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 LocalFrame&ctx) const;
 
       void set_line(perm_string file, perm_string def_file,
                     unsigned lineno, unsigned def_lineno);
@@ -1150,6 +1223,11 @@ class NetScope : public Definitions, public Attrib {
 
       void evaluate_parameters(class Design*);
 
+	/* Note that this scope has defparams to run or parameters to
+	   evaluate. The parents are marked too, so that the passes
+	   above can skip the subtrees that have nothing to do. */
+      void mark_elab_dirty();
+
 	// Look for defparams that never matched, and print warnings.
       void residual_defparams(class Design*);
 
@@ -1238,7 +1316,7 @@ class NetScope : public Definitions, public Attrib {
       perm_string genvar_tmp;
       long genvar_tmp_val;
 
-      std::map<perm_string,LocalVar> loop_index_tmp;
+      LocalFrame*loop_index_tmp;
 
     private:
       void evaluate_parameter_logic_(Design*des, param_ref_t cur);
@@ -1286,10 +1364,16 @@ class NetScope : public Definitions, public Attrib {
       };
       const PFunction*func_pform_;
       unsigned elab_stage_;
+      bool elab_dirty_;
 
       NetScope*unit_;
       NetScope*up_;
       map<hname_t,NetScope*> children_;
+	// The children_ map compares name strings at every step, so
+	// child() looks the children up by a hash of the name instead.
+      multimap<size_t,NetScope*> child_index_;
+      void index_child_(NetScope*that);
+      void unindex_child_(const NetScope*that);
 
       unsigned lcounter_;
       bool need_const_func_, is_const_func_, is_auto_, is_cell_, calls_stask_;
@@ -2040,7 +2124,7 @@ class NetExpr  : public LineInfo {
 	// allocated constant, or nil if the expression cannot be
 	// evaluated for any reason.
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					LocalFrame&ctx) const;
 
 	// Get the Nexus that are the input to this
 	// expression. Normally this descends down to the reference to
@@ -2124,7 +2208,7 @@ class NetEConst  : public NetExpr {
       virtual NexusSet* nex_input(bool rem_out = true);
 
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					LocalFrame&ctx) const;
 
     private:
       verinum value_;
@@ -2196,7 +2280,7 @@ class NetECReal  : public NetExpr {
       virtual NexusSet* nex_input(bool rem_out = true);
 
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					LocalFrame&ctx) const;
 
     private:
       verireal value_;
@@ -2652,7 +2736,7 @@ class NetProc : public virtual LineInfo {
 	// identifiers to values. The function returns true if the
 	// processing succeeds, or false otherwise.
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
 	// This method is called by functors that want to scan a
 	// process in search of matchable patterns.
@@ -2933,12 +3017,12 @@ class NetAssign : public NetAssignBase {
       virtual int match_proc(struct proc_match_t*);
       virtual void dump(ostream&, unsigned ind) const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       void eval_func_lval_op_real_(const LineInfo&loc, verireal&lv, verireal&rv) const;
       void eval_func_lval_op_(const LineInfo&loc, verinum&lv, verinum&rv) const;
-      bool eval_func_lval_(const LineInfo&loc, map<perm_string,LocalVar>&ctx,
+      bool eval_func_lval_(const LineInfo&loc, LocalFrame&ctx,
 			   const NetAssign_*lval, NetExpr*rval_result) const;
 
       char op_;
@@ -2990,7 +3074,7 @@ class NetBlock  : public NetProc {
       const NetProc*proc_next(const NetProc*cur) const;
 
       bool evaluate_function(const LineInfo&loc,
-			     map<perm_string,LocalVar>&ctx) const;
+			     LocalFrame&ctx) const;
 
 	// synthesize as asynchronous logic, and return true.
       bool synth_async(Design*des, NetScope*scope,
@@ -3065,13 +3149,13 @@ class NetCase  : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       bool evaluate_function_vect_(const LineInfo&loc,
-				   map<perm_string,LocalVar>&ctx) const;
+				   LocalFrame&ctx) const;
       bool evaluate_function_real_(const LineInfo&loc,
-				   map<perm_string,LocalVar>&ctx) const;
+				   LocalFrame&ctx) const;
 
       bool synth_async_casez_(Design*des, NetScope*scope,
 			      NexusSet&nex_map, NetBus&nex_out,
@@ -3155,7 +3239,7 @@ class NetCondit  : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       NetExpr* expr_;
@@ -3225,7 +3309,7 @@ class NetDisable  : public NetProc {
       virtual bool emit_proc(struct target_t*) const;
       virtual void dump(ostream&, unsigned ind) const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       NetScope*target_;
@@ -3256,7 +3340,7 @@ class NetDoWhile  : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       NetExpr* cond_;
@@ -3505,7 +3589,7 @@ class NetForever : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       NetProc*statement_;
@@ -3528,7 +3612,7 @@ class NetForLoop : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
 	// synthesize as asynchronous logic, and return true.
       bool synth_async(Design*des, NetScope*scope,
@@ -3596,6 +3680,17 @@ class NetFuncDef : public NetBaseDef {
 
     private:
       NetNet*result_sig_;
+
+	// Number of LocalFrame slots that the function variables use,
+	// or -1 if the slots have not been given out yet.
+      mutable int eval_slots_;
+
+	// Results of evaluate_function() keyed on the constant
+	// argument values. The number of entries is limited so that
+	// a function called to fill a large table does not hold on to
+	// every result.
+      enum { EVAL_CACHE_MAX = 4096 };
+      mutable std::map<std::string,NetExpr*> eval_cache_;
 };
 
 /*
@@ -3654,7 +3749,7 @@ class NetRepeat : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       NetExpr*expr_;
@@ -3705,7 +3800,7 @@ class NetSTask  : public NetProc {
       virtual bool emit_proc(struct target_t*) const;
       virtual void dump(ostream&, unsigned ind) const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       const char* name_;
@@ -3791,7 +3886,7 @@ class NetEUFunc  : public NetExpr {
       virtual NexusSet* nex_input(bool rem_out = true);
       virtual NetExpr* eval_tree();
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					LocalFrame&ctx) const;
 
       virtual NetNet* synthesize(Design*des, NetScope*scope, NetExpr*root);
 
@@ -3877,7 +3972,7 @@ class NetWhile  : public NetProc {
       virtual void dump(ostream&, unsigned ind) const;
       virtual DelayType delay_type() const;
       virtual bool evaluate_function(const LineInfo&loc,
-				     map<perm_string,LocalVar>&ctx) const;
+				     LocalFrame&ctx) const;
 
     private:
       NetExpr* cond_;
@@ -4013,7 +4108,7 @@ class NetEBinary  : public NetExpr {
       virtual NetEBinary* dup_expr() const;
       virtual NetExpr* eval_tree();
       virtual NetExpr* evaluate_function(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 LocalFrame&ctx) const;
       virtual NexusSet* nex_input(bool rem_out = true);
 
       virtual void expr_scan(struct expr_scan_t*) const;
@@ -4272,7 +4367,7 @@ class NetEConcat  : public NetExpr {
       virtual NetEConcat* dup_expr() const;
       virtual NetEConst*  eval_tree();
       virtual NetExpr* evaluate_function(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 LocalFrame&ctx) const;
       virtual NetNet*synthesize(Design*, NetScope*scope, NetExpr*root);
       virtual void expr_scan(struct expr_scan_t*) const;
       virtual void dump(ostream&) const;
@@ -4320,7 +4415,7 @@ class NetESelect  : public NetExpr {
       virtual void expr_scan(struct expr_scan_t*) const;
       virtual NetEConst* eval_tree();
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					LocalFrame&ctx) const;
       virtual NetESelect* dup_expr() const;
       virtual NetNet*synthesize(Design*des, NetScope*scope, NetExpr*root);
       virtual void dump(ostream&) const;
@@ -4495,7 +4590,7 @@ class NetESFunc  : public NetExpr {
 
       virtual NetExpr* eval_tree();
       virtual NetExpr* evaluate_function(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 LocalFrame&ctx) const;
 
       virtual ivl_variable_type_t expr_type() const;
       virtual NexusSet* nex_input(bool rem_out = true);
@@ -4663,7 +4758,7 @@ class NetETernary  : public NetExpr {
       virtual NetETernary* dup_expr() const;
       virtual NetExpr* eval_tree();
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					LocalFrame&ctx) const;
       virtual ivl_variable_type_t expr_type() const;
       virtual NexusSet* nex_input(bool rem_out = true);
       virtual void expr_scan(struct expr_scan_t*) const;
@@ -4716,7 +4811,7 @@ class NetEUnary  : public NetExpr {
       virtual NetEUnary* dup_expr() const;
       virtual NetExpr* eval_tree();
       virtual NetExpr* evaluate_function(const LineInfo&loc,
-					 map<perm_string,LocalVar>&ctx) const;
+					 LocalFrame&ctx) const;
       virtual NetNet* synthesize(Design*, NetScope*scope, NetExpr*root);
 
       virtual ivl_variable_type_t expr_type() const;
@@ -4800,7 +4895,7 @@ class NetESignal  : public NetExpr {
       const netenum_t*enumeration() const;
 
       virtual NetExpr*evaluate_function(const LineInfo&loc,
-					map<perm_string,LocalVar>&ctx) const;
+					LocalFrame&ctx) const;
 
 	// This is the expression for selecting an array word, if this
 	// signal refers to an array.
@@ -24,7 +24,16 @@
  * excess local signals. These deletions are not necessarily required
  * for proper functioning of anything, but they can clean up the
  * appearance of design files that are generated.
+ *
+ * The design is scanned only once. The events that survive the scan
+ * are kept in a list for the later event passes, and the signals
+ * next to a deleted signal are put on a work list, since they are
+ * the only ones that the deletion can make removable.
  */
+# include  <ctime>
+# include  <deque>
+# include  <set>
+# include  <vector>
 # include  "functor.h"
 # include  "netlist.h"
 # include  "compiler.h"
@@ -34,16 +43,26 @@ class nodangle_f  : public functor_t {
       void event(Design*des, NetEvent*ev);
       void signal(Design*des, NetNet*sig);
 
+      void delete_signal(NetNet*sig);
+      unsigned run_signal_list(Design*des);
+      void run_event_pass(Design*des);
+
       unsigned iteration;
       unsigned stotal, etotal;
-      bool scontinue, econtinue;
-      bool scomplete, ecomplete;
+      bool econtinue;
+
+	// The events that are still to be looked at by the later
+	// event passes. Deleted events are set to nil.
+      std::vector<NetEvent*> event_list;
+
+	// Signals that need another look. The set holds the signals
+	// that are on the list and still exist.
+      std::deque<NetNet*> signal_list;
+      std::set<NetNet*> signal_set;
 };
 
 void nodangle_f::event(Design*, NetEvent*ev)
 {
-      if (ecomplete) return;
-
 	/* If there are no references to this event, then go right
 	   ahead and delete it. There is no use looking further at
 	   it. */
@@ -92,6 +111,7 @@ void nodangle_f::event(Design*, NetEvent*ev)
                         }
                   }
             }
+            event_list.push_back(ev);
             econtinue = true;
       } else {
               /* Postpone examining events in an automatic scope until the
@@ -171,10 +191,72 @@ static void check_is_floating(NetNet*sig)
 
 }
 
-void nodangle_f::signal(Design*, NetNet*sig)
+/*
+ * Delete the signal, and put the other signals that it is connected
+ * to on the work list.
+ */
+void nodangle_f::delete_signal(NetNet*sig)
+{
+      std::vector<NetNet*> neighbors;
+      for (unsigned idx = 0 ;  idx < sig->pin_count() ;  idx += 1) {
+	    if (! sig->pin(idx).is_linked())
+		  continue;
+
+	    Nexus*nex = sig->pin(idx).nexus();
+	    for (Link*cur = nex->first_nlink() ; cur ; cur = cur->next_nlink()) {
+		  NetNet*cursig = dynamic_cast<NetNet*>(cur->get_obj());
+		  if (cursig && cursig != sig)
+			neighbors.push_back(cursig);
+	    }
+      }
+
+      signal_set.erase(sig);
+      delete sig;
+      stotal += 1;
+
+      for (size_t idx = 0 ;  idx < neighbors.size() ;  idx += 1) {
+	    if (signal_set.insert(neighbors[idx]).second)
+		  signal_list.push_back(neighbors[idx]);
+      }
+}
+
+unsigned nodangle_f::run_signal_list(Design*des)
 {
-      if (scomplete) return;
+      unsigned visits = 0;
+      while (! signal_list.empty()) {
+	    NetNet*sig = signal_list.front();
+	    signal_list.pop_front();
+	    if (signal_set.erase(sig) == 0)
+		  continue;
 
+	    visits += 1;
+	    signal(des, sig);
+      }
+      return visits;
+}
+
+/*
+ * Run the event method on the events that are left in the list. This
+ * replaces a scan of the whole design for the second and third event
+ * passes.
+ */
+void nodangle_f::run_event_pass(Design*des)
+{
+      econtinue = false;
+      for (size_t idx = 0 ;  idx < event_list.size() ;  idx += 1) {
+	    NetEvent*ev = event_list[idx];
+	    if (ev == 0)
+		  continue;
+
+	    unsigned deleted = etotal;
+	    event(des, ev);
+	    if (etotal != deleted)
+		  event_list[idx] = 0;
+      }
+}
+
+void nodangle_f::signal(Design*, NetNet*sig)
+{
       if (warn_floating_nets && !sig->local_flag() && !floating_net_tested(sig)) {
 	    check_is_floating(sig);
       }
@@ -206,8 +288,7 @@ void nodangle_f::signal(Design*, NetNet*sig)
 	/* Check to see if the signal is completely unconnected. If
 	   all the bits are unlinked, then delete it. */
       if (! sig->is_linked()) {
-	    delete sig;
-	    stotal += 1;
+	    delete_signal(sig);
 	    return;
       }
 
@@ -245,10 +326,8 @@ void nodangle_f::signal(Design*, NetNet*sig)
 
 	/* If every pin is connected to another significant signal,
 	   then I can delete this one. */
-      if (significant_flags == sig->pin_count()) {
-	    delete sig;
-	    stotal += 1;
-      }
+      if (significant_flags == sig->pin_count())
+	    delete_signal(sig);
 }
 
 void nodangle(Design*des)
@@ -257,30 +336,42 @@ void nodangle(Design*des)
       fun.iteration = 0;
       fun.stotal = 0;
       fun.etotal = 0;
-      fun.scomplete = false;
-      fun.ecomplete = false;
-      do {
-	    if (verbose_flag) {
-		  cout << " ... scan for dangling signal and event nodes. "
-		       << "(scomplete=" << (fun.scomplete? "T" : "F")
-		       << ", ecomplete=" << (fun.ecomplete? "T" : "F")
-		       << ")" << endl << flush;
-	    }
 
-            fun.scontinue = false;
-            fun.econtinue = false;
-	    des->functor(&fun);
+      if (verbose_flag) {
+	    cout << " ... scan for dangling signal and event nodes."
+		 << endl << flush;
+      }
+
+	/* The one full scan looks at all the signals and does the
+	   first event pass. */
+      clock_t start = clock();
+      fun.econtinue = false;
+      des->functor(&fun);
+      fun.iteration += 1;
+
+      unsigned visits = fun.run_signal_list(des);
+      if (verbose_flag) {
+	    cout << " ... scan and " << visits << " signal revisits"
+		 << " deleted " << fun.stotal << " dangling signals"
+		 << " and " << fun.etotal << " events ("
+		 << (double)(clock() - start) / CLOCKS_PER_SEC
+		 << " seconds)." << endl << flush;
+      }
+
+	/* The remaining event passes only need the events. */
+      while (fun.econtinue && fun.iteration < 3) {
+	    unsigned etotal = fun.etotal;
+	    start = clock();
+	    fun.run_event_pass(des);
 	    fun.iteration += 1;
-            fun.scomplete = !fun.scontinue;
-            fun.ecomplete = !fun.econtinue;
 
 	    if (verbose_flag) {
-		  cout << " ... " << fun.iteration << " iterations"
-		       << " deleted " << fun.stotal << " dangling signals"
-		       << " and " << fun.etotal << " events." << endl << flush;
+		  cout << " ... event pass " << fun.iteration
+		       << " deleted " << (fun.etotal - etotal) << " events ("
+		       << (double)(clock() - start) / CLOCKS_PER_SEC
+		       << " seconds)." << endl << flush;
 	    }
-
-      } while (fun.scontinue || fun.econtinue);
+      }
 
       if (verbose_flag) {
 	    cout << " ... done" << endl << flush;
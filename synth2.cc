@@ -400,18 +400,18 @@ bool NetAssignBase::synth_async(Design*des, NetScope*scope,
       bool is_part_select = lval_width != lsig_width;
 
       long base_off = 0;
-      if (is_part_select && !scope->loop_index_tmp.empty()) {
+      if (is_part_select && scope->loop_index_tmp) {
 	      // If we are within a NetForLoop, there may be an index
 	      // value. That is collected from the scope member
 	      // loop_index_tmp, and the evaluate_function method
 	      // knows how to apply it.
-	    ivl_assert(*this, !scope->loop_index_tmp.empty());
+	    ivl_assert(*this, scope->loop_index_tmp);
 	    ivl_assert(*this, lval_width < lsig_width);
 
 	      // Evaluate the index expression to a constant.
 	    const NetExpr*base_expr_raw = lval_->get_base();
 	    ivl_assert(*this, base_expr_raw);
-	    NetExpr*base_expr = base_expr_raw->evaluate_function(*this, scope->loop_index_tmp);
+	    NetExpr*base_expr = base_expr_raw->evaluate_function(*this, *scope->loop_index_tmp);
 	    if (! eval_as_long(base_off, base_expr)) {
 		  ivl_assert(*this, 0);
 	    }
@@ -436,12 +436,13 @@ bool NetAssignBase::synth_async(Design*des, NetScope*scope,
 	      // In this case, there is no loop_index_tmp, so we are
 	      // not within a NetForLoop. Generate a NetSubstitute
 	      // object to handle the bit/part-select in the l-value.
-	    ivl_assert(*this, scope->loop_index_tmp.empty());
+	    ivl_assert(*this, scope->loop_index_tmp == 0);
 	    ivl_assert(*this, lval_width < lsig_width);
 
 	    const NetExpr*base_expr_raw = lval_->get_base();
 	    ivl_assert(*this, base_expr_raw);
-	    NetExpr*base_expr = base_expr_raw->evaluate_function(*this, scope->loop_index_tmp);
+	    LocalFrame no_locals (0, 0);
+	    NetExpr*base_expr = base_expr_raw->evaluate_function(*this, no_locals);
 	    if (! eval_as_long(base_off, base_expr)) {
 		  cerr << get_fileline() << ": sorry: assignment to variable "
 			  "bit location is not currently supported in "
@@ -1458,16 +1459,16 @@ bool NetForLoop::synth_async(Design*des, NetScope*scope,
       ivl_assert(*this, step_assign);
       NetExpr*step_expr = step_assign->rval();
 
-	// Tell the scope that this index value is like a genvar.
-      LocalVar index_var;
-      index_var.nwords = 0;
-
-      map<perm_string,LocalVar> index_args;
+	// Tell the scope that this index value is like a genvar. The
+	// index is the only variable in the frame, and the frame owns
+	// its value.
+      index_->eval_slot(this, 0);
+      LocalFrame index_args (this, 1);
+      LocalVar&index_var = *index_args.find(index_);
 
 	// Calculate the initial value for the index.
       index_var.value = init_expr_->evaluate_function(*this, index_args);
       ivl_assert(*this, index_var.value);
-      index_args[index_->name()] = index_var;
 
       for (;;) {
 	      // Evaluate the condition expression. If it is false,
@@ -1494,8 +1495,8 @@ bool NetForLoop::synth_async(Design*des, NetScope*scope,
 	      // Synthesize the iterated expression. Stash the loop
 	      // index value so that the substatements can see this
 	      // value and use it during its own synthesis.
-	    ivl_assert(*this, scope->loop_index_tmp.empty());
-	    scope->loop_index_tmp = index_args;
+	    ivl_assert(*this, scope->loop_index_tmp == 0);
+	    scope->loop_index_tmp = &index_args;
 
 	    NetBus tmp_ena (scope, nex_out.pin_count());
 	    vector<mask_t> tmp_masks (nex_out.pin_count());
@@ -1508,7 +1509,7 @@ bool NetForLoop::synth_async(Design*des, NetScope*scope,
 		  merge_sequential_masks(bitmasks[idx], tmp_masks[idx]);
 	    }
 
-	    scope->loop_index_tmp.clear();
+	    scope->loop_index_tmp = 0;
 
 	      // Evaluate the step_expr to generate the next index value.
 	    tmp = step_expr->evaluate_function(*this, index_args);
@@ -1536,11 +1537,8 @@ bool NetForLoop::synth_async(Design*des, NetScope*scope,
 	    }
 	    delete index_var.value;
 	    index_var.value = tmp;
-	    index_args[index_->name()] = index_var;
       }
 
-      delete index_var.value;
-
       return true;
 }
 
@@ -43,18 +43,122 @@ extern "C" long int lround(double x)
 
 static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c);
 
+/*
+ * Return the mask of the bits of the last word of an nbits wide
+ * number that are inside the number.
+ */
+static inline uint64_t top_word_mask(unsigned nbits)
+{
+      unsigned rem = nbits % 64;
+      return rem ? (((uint64_t)1 << rem) - 1) : ~(uint64_t)0;
+}
+
+/*
+ * Return the word of a plane of the value filled with the given pad
+ * bit past the end of the value. This is how operands of different
+ * widths are extended a word at a time.
+ */
+static uint64_t ext_aword(const verinum&val, unsigned idx, verinum::V pad)
+{
+      uint64_t fill = (pad & 1) ? ~(uint64_t)0 : 0;
+      if ((uint64_t)idx * 64 >= val.len())
+	    return fill;
+
+      uint64_t word = val.get_aword(idx);
+      if ((uint64_t)idx * 64 + 64 > val.len())
+	    word |= fill & ~top_word_mask(val.len());
+      return word;
+}
+
+static uint64_t ext_bword(const verinum&val, unsigned idx, verinum::V pad)
+{
+      uint64_t fill = (pad & 2) ? ~(uint64_t)0 : 0;
+      if ((uint64_t)idx * 64 >= val.len())
+	    return fill;
+
+      uint64_t word = val.get_bword(idx);
+      if ((uint64_t)idx * 64 + 64 > val.len())
+	    word |= fill & ~top_word_mask(val.len());
+      return word;
+}
+
+/*
+ * Return the 64 bits of a plane that start at bit off, which may be
+ * negative. Bits outside the value are 0.
+ */
+static uint64_t plane_bits(const verinum&val, bool bplane, int64_t off)
+{
+      if (off <= -64)
+	    return 0;
+
+      if (off < 0) {
+	    if (val.nwords() == 0)
+		  return 0;
+	    uint64_t word = bplane ? val.get_bword(0) : val.get_aword(0);
+	    return word << -off;
+      }
+
+      unsigned widx = off / 64;
+      unsigned shift = off % 64;
+      uint64_t lo = 0, hi = 0;
+      if (widx < val.nwords())
+	    lo = bplane ? val.get_bword(widx) : val.get_aword(widx);
+      if (shift == 0)
+	    return lo;
+      if (widx+1 < val.nwords())
+	    hi = bplane ? val.get_bword(widx+1) : val.get_aword(widx+1);
+      return (lo >> shift) | (hi << (64 - shift));
+}
+
 verinum::verinum()
-: bits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
+: abits_(0), bbits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
 {
 }
 
+void verinum::allocate_(unsigned nbits)
+{
+      nbits_ = nbits;
+      unsigned nw = nwords();
+      if (nw == 0) {
+	    abits_ = 0;
+	    bbits_ = 0;
+	    return;
+      }
+
+      abits_ = new uint64_t[2*nw];
+      bbits_ = abits_ + nw;
+      for (unsigned idx = 0 ;  idx < 2*nw ;  idx += 1)
+	    abits_[idx] = 0;
+}
+
+/*
+ * Set all the bits from bit from up to the value val.
+ */
+void verinum::fill_(unsigned from, V val)
+{
+      uint64_t afill = (val & 1) ? ~(uint64_t)0 : 0;
+      uint64_t bfill = (val & 2) ? ~(uint64_t)0 : 0;
+
+      for (unsigned idx = from / 64 ;  idx < nwords() ;  idx += 1) {
+	    uint64_t mask = ~(uint64_t)0;
+	    if (idx == from / 64)
+		  mask <<= from % 64;
+	    abits_[idx] = (abits_[idx] & ~mask) | (afill & mask);
+	    bbits_[idx] = (bbits_[idx] & ~mask) | (bfill & mask);
+      }
+
+      if (nbits_ > 0) {
+	    abits_[nwords()-1] &= top_word_mask(nbits_);
+	    bbits_[nwords()-1] &= top_word_mask(nbits_);
+      }
+}
+
 verinum::verinum(const V*bits, unsigned nbits, bool has_len__)
 : has_len_(has_len__), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = nbits;
-      bits_ = new V [nbits];
+      allocate_(nbits);
       for (unsigned idx = 0 ;  idx < nbits ;  idx += 1) {
-	    bits_[idx] = bits[idx];
+	    set(idx, bits[idx]);
       }
 }
 
@@ -115,58 +219,37 @@ verinum::verinum(const string&s)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(true)
 {
       string str = process_verilog_string_quotes(s);
-      nbits_ = str.length() * 8;
 
 	// Special case: The string "" is 8 bits of 0.
-      if (nbits_ == 0) {
-	    nbits_ = 8;
-	    bits_ = new V [nbits_];
-	    bits_[0] = V0;
-	    bits_[1] = V0;
-	    bits_[2] = V0;
-	    bits_[3] = V0;
-	    bits_[4] = V0;
-	    bits_[5] = V0;
-	    bits_[6] = V0;
-	    bits_[7] = V0;
+      if (str.length() == 0) {
+	    allocate_(8);
 	    return;
       }
 
-      bits_ = new V [nbits_];
+      allocate_(str.length() * 8);
 
       unsigned idx, cp;
-      V*bp = bits_+nbits_;
       for (idx = nbits_, cp = 0 ;  idx > 0 ;  idx -= 8, cp += 1) {
-	    char ch = str[cp];
-	    *(--bp) = (ch&0x80) ? V1 : V0;
-	    *(--bp) = (ch&0x40) ? V1 : V0;
-	    *(--bp) = (ch&0x20) ? V1 : V0;
-	    *(--bp) = (ch&0x10) ? V1 : V0;
-	    *(--bp) = (ch&0x08) ? V1 : V0;
-	    *(--bp) = (ch&0x04) ? V1 : V0;
-	    *(--bp) = (ch&0x02) ? V1 : V0;
-	    *(--bp) = (ch&0x01) ? V1 : V0;
+	    unsigned char ch = str[cp];
+	    unsigned bit = idx - 8;
+	    abits_[bit/64] |= (uint64_t)ch << (bit%64);
       }
 }
 
 verinum::verinum(verinum::V val, unsigned n, bool h)
 : has_len_(h), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = val;
+      allocate_(n);
+      if (val != V0)
+	    fill_(0, val);
 }
 
 verinum::verinum(uint64_t val, unsigned n)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (val&1) ? V1 : V0;
-	    val >>= (uint64_t)1;
-      }
+      allocate_(n);
+      if (n > 0)
+	    set_words(0, val, 0);
 }
 
 /* The second argument is not used! It is there to make this
@@ -181,9 +264,8 @@ verinum::verinum(double val, bool)
 
 	/* We return `bx for a NaN or +/- infinity. */
       if (val != val || (val && (val == 0.5*val))) {
-	    nbits_ = 1;
-	    bits_ = new V[nbits_];
-	    bits_[0] = Vx;
+	    allocate_(1);
+	    set(0, Vx);
 	    return;
       }
 
@@ -199,15 +281,14 @@ verinum::verinum(double val, bool)
 
 	/* Get the exponent and fractional part of the number. */
       fraction = frexp(val, &exponent);
-      nbits_ = exponent+1;
-      bits_ = new V[nbits_];
+      allocate_(exponent+1);
 
 	/* If the value is small enough just use lround(). */
       if (nbits_ <= BITS_IN_LONG) {
 	    long sval = lround(val);
 	    if (is_neg) sval = -sval;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (sval&1) ? V1 : V0;
+		  set(idx, (sval&1) ? V1 : V0);
 		  sval >>= 1;
 	    }
 	      /* Trim the result. */
@@ -223,7 +304,7 @@ verinum::verinum(double val, bool)
 	    unsigned long bits = (unsigned long) fraction;
 	    fraction = fraction - (double) bits;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (bits&1) ? V1 : V0;
+		  set(idx, (bits&1) ? V1 : V0);
 		  bits >>= 1;
 	    }
       } else {
@@ -233,7 +314,7 @@ verinum::verinum(double val, bool)
 		  unsigned max_idx = (wd+1)*BITS_IN_LONG;
 		  if (max_idx > nbits_) max_idx = nbits_;
 		  for (unsigned idx = wd*BITS_IN_LONG; idx < max_idx; idx += 1) {
-			bits_[idx] = (bits&1) ? V1 : V0;
+			set(idx, (bits&1) ? V1 : V0);
 			bits >>= 1;
 		  }
 		  fraction = ldexp(fraction, BITS_IN_LONG);
@@ -256,62 +337,61 @@ void verinum::signed_trim()
 {
 	/* Do we have any extra digits? */
       unsigned tlen = nbits_-1;
-      verinum::V sign = bits_[tlen];
-      while ((tlen > 0) && (bits_[tlen] == sign)) tlen -= 1;
+      verinum::V sign = get(tlen);
+      while ((tlen > 0) && (get(tlen) == sign)) tlen -= 1;
 
 	/* tlen now points to the first digit that is not the sign.
 	 * or bit 0. Set the length to include this bit and one proper
 	 * sign bit if needed. */
-      if (bits_[tlen] != sign) tlen += 1;
+      if (get(tlen) != sign) tlen += 1;
       tlen += 1;
 
 	/* Trim the bits if needed. */
       if (tlen < nbits_) {
-	    V* tbits = new V[tlen];
-	    for (unsigned idx = 0; idx < tlen; idx += 1)
-		  tbits[idx] = bits_[idx];
-	    delete[] bits_;
-	    bits_ = tbits;
-	    nbits_ = tlen;
+	    uint64_t*old_bits = abits_;
+	    unsigned old_nwords = nwords();
+	    allocate_(tlen);
+	    for (unsigned idx = 0; idx < nwords(); idx += 1)
+		  set_words(idx, old_bits[idx], old_bits[old_nwords+idx]);
+	    delete[] old_bits;
       }
 }
 
 verinum::verinum(const verinum&that)
 {
       string_flag_ = that.string_flag_;
-      nbits_ = that.nbits_;
-      bits_ = new V[nbits_];
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
       is_single_ = that.is_single_;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
+      allocate_(that.nbits_);
+      for (unsigned idx = 0 ;  idx < 2*nwords() ;  idx += 1)
+	    abits_[idx] = that.abits_[idx];
 }
 
 verinum::verinum(const verinum&that, unsigned nbits)
 {
       string_flag_ = that.string_flag_ && (that.nbits_ == nbits);
-      nbits_ = nbits;
-      bits_ = new V[nbits_];
       has_len_ = true;
       has_sign_ = that.has_sign_;
       is_single_ = false;
+      allocate_(nbits);
 
       unsigned copy = nbits;
       if (copy > that.nbits_)
 	    copy = that.nbits_;
-      for (unsigned idx = 0 ;  idx < copy ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
 
-      if (copy < nbits_) {
-	    if (has_sign_ || that.is_single_) {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = bits_[idx-1];
-	    } else {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = verinum::V0;
-	    }
+      unsigned copy_words = (copy + 63) / 64;
+      for (unsigned idx = 0 ;  idx < copy_words ;  idx += 1) {
+	    abits_[idx] = that.abits_[idx];
+	    bbits_[idx] = that.bbits_[idx];
       }
+      if (copy_words > 0 && copy % 64) {
+	    abits_[copy_words-1] &= top_word_mask(copy);
+	    bbits_[copy_words-1] &= top_word_mask(copy);
+      }
+
+      if (copy < nbits_ && copy > 0 && (has_sign_ || that.is_single_))
+	    fill_(copy, get(copy-1));
 }
 
 verinum::verinum(int64_t that)
@@ -321,36 +401,36 @@ verinum::verinum(int64_t that)
 
       if (that < 0) tmp = (that+1)/2;
       else tmp = that/2;
-      nbits_ = 1;
+      unsigned nbits = 1;
       while (tmp != 0) {
-	    nbits_ += 1;
+	    nbits += 1;
 	    tmp /= 2;
       }
 
-      nbits_ += 1;
+      nbits += 1;
 
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (that & 1)? V1 : V0;
-	    that >>= 1;
+      allocate_(nbits);
+      for (unsigned idx = 0 ;  idx < nwords() ;  idx += 1) {
+	    uint64_t word = idx == 0 ? (uint64_t)that
+				     : (that < 0 ? ~(uint64_t)0 : 0);
+	    set_words(idx, word, 0);
       }
 }
 
 verinum::~verinum()
 {
-      delete[]bits_;
+      delete[]abits_;
 }
 
 verinum& verinum::operator= (const verinum&that)
 {
       if (this == &that) return *this;
       if (nbits_ != that.nbits_) {
-            delete[]bits_;
-            nbits_ = that.nbits_;
-            bits_ = new V[that.nbits_];
+	    delete[]abits_;
+	    allocate_(that.nbits_);
       }
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
+      for (unsigned idx = 0 ;  idx < 2*nwords() ;  idx += 1)
+	    abits_[idx] = that.abits_[idx];
 
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
@@ -362,77 +442,99 @@ verinum& verinum::operator= (const verinum&that)
 verinum::V verinum::get(unsigned idx) const
 {
       assert(idx < nbits_);
-      return bits_[idx];
+      unsigned shift = idx % 64;
+      unsigned val = (abits_[idx/64] >> shift) & 1;
+      val |= ((bbits_[idx/64] >> shift) & 1) << 1;
+      return (V)val;
 }
 
 verinum::V verinum::set(unsigned idx, verinum::V val)
 {
       assert(idx < nbits_);
-      return bits_[idx] = val;
+      uint64_t mask = (uint64_t)1 << (idx % 64);
+      if (val & 1)
+	    abits_[idx/64] |= mask;
+      else
+	    abits_[idx/64] &= ~mask;
+      if (val & 2)
+	    bbits_[idx/64] |= mask;
+      else
+	    bbits_[idx/64] &= ~mask;
+      return val;
 }
 
 void verinum::set(unsigned off, const verinum&val)
 {
       assert(off + val.len() <= nbits_);
-      for (unsigned idx = 0 ; idx < val.len() ; idx += 1)
-	    bits_[off+idx] = val[idx];
-}
+      unsigned shift = off % 64;
 
-unsigned verinum::as_unsigned() const
-{
-      if (nbits_ == 0)
-	    return 0;
+      for (unsigned idx = 0 ;  idx < val.nwords() ;  idx += 1) {
+	    unsigned widx = off/64 + idx;
+	    unsigned cnt = val.len() - idx*64;
+	    if (cnt > 64) cnt = 64;
+	    uint64_t mask = cnt < 64 ? (((uint64_t)1 << cnt) - 1) : ~(uint64_t)0;
 
-      if (!is_defined())
-	    return 0;
+	    abits_[widx] = (abits_[widx] & ~(mask << shift))
+			 | (val.abits_[idx] << shift);
+	    bbits_[widx] = (bbits_[widx] & ~(mask << shift))
+			 | (val.bbits_[idx] << shift);
 
-      unsigned val = 0;
-      unsigned mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+	    if (shift == 0 || shift + cnt <= 64)
+		  continue;
 
-      return val;
+	    abits_[widx+1] = (abits_[widx+1] & ~(mask >> (64-shift)))
+			   | (val.abits_[idx] >> (64-shift));
+	    bbits_[widx+1] = (bbits_[widx+1] & ~(mask >> (64-shift)))
+			   | (val.bbits_[idx] >> (64-shift));
+      }
 }
 
-unsigned long verinum::as_ulong() const
+void verinum::set_words(unsigned idx, uint64_t a, uint64_t b)
 {
-      if (nbits_ == 0)
+      assert(idx < nwords());
+      if (idx == nwords()-1) {
+	    a &= top_word_mask(nbits_);
+	    b &= top_word_mask(nbits_);
+      }
+      abits_[idx] = a;
+      bbits_[idx] = b;
+}
+
+/*
+ * Return the defined value as an unsigned integer of the given width,
+ * or all ones if it does not fit.
+ */
+static uint64_t saturate_value(const verinum&val, unsigned width)
+{
+      if (val.len() == 0)
 	    return 0;
 
-      if (!is_defined())
+      if (!val.is_defined())
 	    return 0;
 
-      unsigned long val = 0;
-      unsigned long mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+      uint64_t limit = width < 64 ? (((uint64_t)1 << width) - 1) : ~(uint64_t)0;
+      for (unsigned idx = 1 ;  idx < val.nwords() ;  idx += 1)
+	    if (val.get_aword(idx)) return limit;
 
-      return val;
+      uint64_t word = val.get_aword(0);
+      if (word & ~limit)
+	    return limit;
+      return word;
 }
 
-uint64_t verinum::as_ulong64() const
+unsigned verinum::as_unsigned() const
 {
-      if (nbits_ == 0)
-	    return 0;
-
-      if (!is_defined())
-	    return 0;
+      return saturate_value(*this, 8*sizeof(unsigned));
+}
 
-      uint64_t val = 0;
-      uint64_t mask = 1;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1) {
-		  if (mask == 0) return ~mask;
-		  val |= mask;
-	    }
+unsigned long verinum::as_ulong() const
+{
+      return saturate_value(*this, 8*sizeof(unsigned long));
+}
 
-      return val;
+uint64_t verinum::as_ulong64() const
+{
+      return saturate_value(*this, 64);
 }
 
 /*
@@ -465,26 +567,26 @@ signed long verinum::as_long() const
       }
       int lost_bits=0;
 
-      if (has_sign_ && (bits_[nbits_-1] == V1)) {
+      if (has_sign_ && (get(nbits_-1) == V1)) {
 	    val = -1;
 	    signed long mask = ~1L;
 	    for (unsigned idx = 0 ;  idx < top ;  idx += 1) {
-		  if (bits_[idx] == V0) val &= mask;
+		  if (get(idx) == V0) val &= mask;
 		  mask = (mask << 1) | 1L;
 	    }
 	    if (diag_top) {
 		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V0) lost_bits=1;
+			if (get(idx) == V0) lost_bits=1;
 		  }
 	    }
       } else {
 	    signed long mask = 1;
 	    for (unsigned idx = 0 ;  idx < top ;  idx += 1, mask <<= 1) {
-		  if (bits_[idx] == V1) val |= mask;
+		  if (get(idx) == V1) val |= mask;
 	    }
 	    if (diag_top) {
 		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V1) lost_bits=1;
+			if (get(idx) == V1) lost_bits=1;
 		  }
 	    }
       }
@@ -501,17 +603,17 @@ double verinum::as_double() const
 
       double val = 0.0;
         /* Do we have/want a signed value? */
-      if (has_sign_ && bits_[nbits_-1] == V1) {
+      if (has_sign_ && get(nbits_-1) == V1) {
 	    V carry = V1;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  V sum = add_with_carry(~bits_[idx], V0, carry);
+		  V sum = add_with_carry(~get(idx), V0, carry);
 		  if (sum == V1)
 			val += pow(2.0, (double)idx);
 	    }
 	    val *= -1.0;
       } else {
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  if (bits_[idx] == V1)
+		  if (get(idx) == V1)
 			val += pow(2.0, (double)idx);
 	    }
       }
@@ -526,17 +628,8 @@ string verinum::as_string() const
 
       string res;
       for (unsigned idx = nbits_ ;  idx > 0 ;  idx -= 8) {
-	    char char_val = 0;
-	    V*bp = bits_+idx;
-
-	    if (*(--bp) == V1) char_val |= 0x80;
-	    if (*(--bp) == V1) char_val |= 0x40;
-	    if (*(--bp) == V1) char_val |= 0x20;
-	    if (*(--bp) == V1) char_val |= 0x10;
-	    if (*(--bp) == V1) char_val |= 0x08;
-	    if (*(--bp) == V1) char_val |= 0x04;
-	    if (*(--bp) == V1) char_val |= 0x02;
-	    if (*(--bp) == V1) char_val |= 0x01;
+	    unsigned bit = idx - 8;
+	    char char_val = (abits_[bit/64] >> (bit%64)) & 0xff;
 
 	    if (char_val == '"' || char_val == '\\') {
 		  char tmp[5];
@@ -559,32 +652,31 @@ bool verinum::is_before(const verinum&that) const
       if (that.nbits_ < nbits_) return false;
 
       for (unsigned idx = nbits_  ;  idx > 0 ;  idx -= 1) {
-	    if (bits_[idx-1] < that.bits_[idx-1]) return true;
-	    if (bits_[idx-1] > that.bits_[idx-1]) return false;
+	    if (get(idx-1) < that.get(idx-1)) return true;
+	    if (get(idx-1) > that.get(idx-1)) return false;
       }
       return false;
 }
 
 bool verinum::is_defined() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx) return false;
-	    if (bits_[idx] == Vz) return false;
+      for (unsigned idx = 0 ;  idx < nwords() ;  idx += 1) {
+	    if (bbits_[idx]) return false;
       }
       return true;
 }
 
 bool verinum::is_zero() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    if (bits_[idx] != V0) return false;
+      for (unsigned idx = 0 ;  idx < nwords() ;  idx += 1)
+	    if (abits_[idx] || bbits_[idx]) return false;
 
       return true;
 }
 
 bool verinum::is_negative() const
 {
-      return (bits_[nbits_-1] == V1) && has_sign();
+      return (get(nbits_-1) == V1) && has_sign();
 }
 
 unsigned verinum::significant_bits() const
@@ -592,11 +684,11 @@ unsigned verinum::significant_bits() const
       unsigned sbits = nbits_;
 
       if (has_sign_) {
-	    V sign_bit = bits_[sbits-1];
-	    while ((sbits > 1) && (bits_[sbits-2] == sign_bit))
+	    V sign_bit = get(sbits-1);
+	    while ((sbits > 1) && (get(sbits-2) == sign_bit))
 		  sbits -= 1;
       } else {
-	    while ((sbits > 1) && (bits_[sbits-1] == verinum::V0))
+	    while ((sbits > 1) && (get(sbits-1) == verinum::V0))
 		  sbits -= 1;
       }
       return sbits;
@@ -604,9 +696,9 @@ unsigned verinum::significant_bits() const
 
 void verinum::cast_to_int2()
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx || bits_[idx] == Vz)
-		  bits_[idx] = V0;
+      for (unsigned idx = 0 ;  idx < nwords() ;  idx += 1) {
+	    abits_[idx] &= ~bbits_[idx];
+	    bbits_[idx] = 0;
       }
 }
 
@@ -632,9 +724,7 @@ verinum pad_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, that.has_len());
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       if (that.is_string() && (width % 8) == 0) {
@@ -668,9 +758,7 @@ verinum cast_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, true);
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       return val;
@@ -735,8 +823,8 @@ verinum trim_vnum(const verinum&that)
 
       verinum tmp (verinum::V0, tlen, false);
       tmp.has_sign(that.has_sign());
-      for (unsigned idx = 0 ;  idx < tmp.len() ;  idx += 1)
-	    tmp.set(idx, that.get(idx));
+      for (unsigned idx = 0 ;  idx < tmp.nwords() ;  idx += 1)
+	    tmp.set_words(idx, that.get_aword(idx), that.get_bword(idx));
 
       return tmp;
 }
@@ -837,14 +925,13 @@ verinum::V operator == (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
-      unsigned max_len = left.len();
-      if (right.len() > max_len)
-	    max_len = right.len();
-
-      for (unsigned idx = 0 ;  idx < max_len ;  idx += 1) {
-	    verinum::V left_bit  = idx < left.len() ? left[idx]  : left_pad;
-	    verinum::V right_bit = idx < right.len()? right[idx] : right_pad;
-	    if (left_bit != right_bit)
+      unsigned max_len = max(left.len(), right.len());
+      unsigned nwords = (max_len + 63) / 64;
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    uint64_t mask = idx+1 == nwords ? top_word_mask(max_len) : ~(uint64_t)0;
+	    uint64_t adif = ext_aword(left, idx, left_pad) ^ ext_aword(right, idx, right_pad);
+	    uint64_t bdif = ext_bword(left, idx, left_pad) ^ ext_bword(right, idx, right_pad);
+	    if ((adif | bdif) & mask)
 		  return verinum::V0;
       }
 
@@ -866,6 +953,20 @@ verinum::V operator <= (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
+	// With no x or z bits, this is a plain compare of the padded
+	// values, a word at a time from the top. If the values are
+	// signed, the padding is the same on both sides by now.
+      if (left.is_defined() && right.is_defined()) {
+	    unsigned nwords = max(left.nwords(), right.nwords());
+	    for (unsigned idx = nwords ;  idx > 0 ;  idx -= 1) {
+		  uint64_t lword = ext_aword(left, idx-1, left_pad);
+		  uint64_t rword = ext_aword(right, idx-1, right_pad);
+		  if (lword != rword)
+			return lword < rword ? verinum::V1 : verinum::V0;
+	    }
+	    return verinum::V1;
+      }
+
       unsigned idx;
       for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
 	    if (left[idx-1] != right_pad) {
@@ -918,6 +1019,20 @@ verinum::V operator < (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
+	// With no x or z bits, this is a plain compare of the padded
+	// values, a word at a time from the top. If the values are
+	// signed, the padding is the same on both sides by now.
+      if (left.is_defined() && right.is_defined()) {
+	    unsigned nwords = max(left.nwords(), right.nwords());
+	    for (unsigned idx = nwords ;  idx > 0 ;  idx -= 1) {
+		  uint64_t lword = ext_aword(left, idx-1, left_pad);
+		  uint64_t rword = ext_aword(right, idx-1, right_pad);
+		  if (lword != rword)
+			return lword < rword ? verinum::V1 : verinum::V0;
+	    }
+	    return verinum::V0;
+      }
+
       unsigned idx;
       for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
 	    if (left[idx-1] != right_pad) {
@@ -1002,23 +1117,51 @@ static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c)
 
 verinum operator ~ (const verinum&left)
 {
+	// 0 and 1 flip, and x and z both become x (a=0/b=1).
       verinum val = left;
-      for (unsigned idx = 0 ;  idx < val.len() ;  idx += 1)
-	    switch (val[idx]) {
-		case verinum::V0:
-		  val.set(idx, verinum::V1);
-		  break;
-		case verinum::V1:
-		  val.set(idx, verinum::V0);
-		  break;
-		default:
-		  val.set(idx, verinum::Vx);
-		  break;
-	    }
+      for (unsigned idx = 0 ;  idx < val.nwords() ;  idx += 1) {
+	    uint64_t a = val.get_aword(idx);
+	    uint64_t b = val.get_bword(idx);
+	    val.set_words(idx, ~a & ~b, b);
+      }
 
       return val;
 }
 
+/*
+ * Add two words and a carry in, and return the sum and the carry out.
+ */
+static inline uint64_t add_words(uint64_t l, uint64_t r, uint64_t&carry)
+{
+      uint64_t sum = l + r;
+      uint64_t c = sum < l;
+      sum += carry;
+      c += sum < carry;
+      carry = c;
+      return sum;
+}
+
+/*
+ * Multiply two words into a 128 bit product, returned as the high
+ * and low words.
+ */
+static inline void multiply_words(uint64_t l, uint64_t r,
+				  uint64_t&hi, uint64_t&lo)
+{
+      const uint64_t mask = 0xffffffff;
+      uint64_t l_lo = l & mask, l_hi = l >> 32;
+      uint64_t r_lo = r & mask, r_hi = r >> 32;
+
+      uint64_t p0 = l_lo * r_lo;
+      uint64_t p1 = l_lo * r_hi;
+      uint64_t p2 = l_hi * r_lo;
+      uint64_t p3 = l_hi * r_hi;
+
+      uint64_t mid = (p0 >> 32) + (p1 & mask) + (p2 & mask);
+      lo = (p0 & mask) | (mid << 32);
+      hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+}
+
 /*
  * Addition and subtraction works a bit at a time, from the least
  * significant up to the most significant. The result is signed only
@@ -1031,7 +1174,6 @@ verinum operator + (const verinum&left, const verinum&right)
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1043,40 +1185,31 @@ verinum operator + (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V0;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], right[idx], carry);
-
+	// Add the padded operands a word at a time, into one more bit
+	// than the wider operand in case the sum grows.
       verinum::V rpad = sign_bit(right);
       verinum::V lpad = sign_bit(left);
 
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, right[idx], carry);
+      verinum sum (verinum::V0, max_len+1, has_len_flag);
+      uint64_t carry = 0;
+      for (unsigned idx = 0 ;  idx < sum.nwords() ;  idx += 1) {
+	    uint64_t word = add_words(ext_aword(left, idx, lpad),
+				      ext_aword(right, idx, rpad), carry);
+	    sum.set_words(idx, word, 0);
       }
 
       unsigned len = max_len;
       if (!has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, rpad, carry);
 	    if (signed_flag) {
-		  if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+		  if (sum[max_len] != sum[max_len-1]) len += 1;
 	    } else {
-		  if (val_bits[max_len] != verinum::V0) len += 1;
+		  if (sum[max_len] != verinum::V0) len += 1;
 	    }
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (sum, len);
+      result.has_len(has_len_flag);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1085,7 +1218,6 @@ verinum operator - (const verinum&left, const verinum&right)
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1097,36 +1229,27 @@ verinum operator - (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], ~right[idx], carry);
-
+	// Subtract by adding the complement of the padded right
+	// operand and a carry in of 1.
       verinum::V rpad = sign_bit(right);
       verinum::V lpad = sign_bit(left);
 
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], ~rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, ~right[idx], carry);
+      verinum dif (verinum::V0, max_len+1, has_len_flag);
+      uint64_t carry = 1;
+      for (unsigned idx = 0 ;  idx < dif.nwords() ;  idx += 1) {
+	    uint64_t word = add_words(ext_aword(left, idx, lpad),
+				      ~ext_aword(right, idx, rpad), carry);
+	    dif.set_words(idx, word, 0);
       }
 
       unsigned len = max_len;
       if (signed_flag && !has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, ~rpad, carry);
-	    if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+	    if (dif[max_len] != dif[max_len-1]) len += 1;
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (dif, len);
+      result.has_len(has_len_flag);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1145,21 +1268,21 @@ verinum operator - (const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[len+1];
-
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(verinum::V0, ~right[idx], carry);
+      verinum::V pad = sign_bit(right);
+      verinum neg (verinum::V0, len+1, has_len_flag);
+      uint64_t carry = 1;
+      for (unsigned idx = 0 ;  idx < neg.nwords() ;  idx += 1) {
+	    uint64_t word = add_words(0, ~ext_aword(right, idx, pad), carry);
+	    neg.set_words(idx, word, 0);
+      }
 
       if (signed_flag && !has_len_flag) {
-	    val_bits[len] = add_with_carry(verinum::V0, ~sign_bit(right), carry);
-	    if (val_bits[len] != val_bits[len-1]) len += 1;
+	    if (neg[len] != neg[len-1]) len += 1;
       }
-      verinum result (val_bits, len, has_len_flag);
+      verinum result (neg, len);
+      result.has_len(has_len_flag);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1169,8 +1292,8 @@ verinum operator - (const verinum&right)
  * operand is unsized, the resulting number is as large as the sum of
  * the sizes of the operands.
  *
- * The algorithm used is successive shift and add operations,
- * implemented as the nested loops.
+ * The algorithm used is long multiplication of the operands, padded
+ * to the result width, a word at a time.
  */
 verinum operator * (const verinum&left, const verinum&right)
 {
@@ -1193,23 +1316,34 @@ verinum operator * (const verinum&left, const verinum&right)
       verinum result(verinum::V0, len, has_len_flag);
       result.has_sign(signed_flag);
 
-      verinum::V r_sign = sign_bit(right);
-      for (unsigned rdx = 0 ;  rdx < len ;  rdx += 1) {
+      const unsigned nwords = result.nwords();
+      uint64_t*prod = new uint64_t[nwords];
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1)
+	    prod[idx] = 0;
 
-	    verinum::V r_bit = rdx < r_len ? right.get(rdx) : r_sign;
-	    if (r_bit == verinum::V0)
+      verinum::V l_sign = sign_bit(left);
+      verinum::V r_sign = sign_bit(right);
+      for (unsigned rdx = 0 ;  rdx < nwords ;  rdx += 1) {
+	    uint64_t r_word = ext_aword(right, rdx, r_sign);
+	    if (r_word == 0)
 		  continue;
 
-	    verinum::V l_sign = sign_bit(left);
-	    verinum::V carry = verinum::V0;
-	    for (unsigned ldx = 0 ;  ldx < (len - rdx) ;  ldx += 1) {
-		  verinum::V l_bit = ldx < l_len ? left[ldx] : l_sign;
-		  result.set(ldx+rdx, add_with_carry(l_bit,
-						     result[rdx+ldx],
-						     carry));
+	    uint64_t carry = 0;
+	    for (unsigned ldx = 0 ;  ldx < (nwords - rdx) ;  ldx += 1) {
+		  uint64_t hi, lo;
+		  multiply_words(ext_aword(left, ldx, l_sign), r_word, hi, lo);
+		  uint64_t c = 0;
+		  prod[ldx+rdx] = add_words(prod[ldx+rdx], lo, c);
+		  uint64_t c2 = 0;
+		  prod[ldx+rdx] = add_words(prod[ldx+rdx], carry, c2);
+		  carry = hi + c + c2;
 	    }
       }
 
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1)
+	    result.set_words(idx, prod[idx], 0);
+      delete[]prod;
+
       return trim_vnum(result);
 }
 
@@ -1313,8 +1447,11 @@ verinum operator << (const verinum&that, unsigned shift)
       verinum result(verinum::V0, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < len ;  idx += 1)
-	    result.set(idx, that.get(idx - shift));
+      for (unsigned idx = 0 ;  idx < result.nwords() ;  idx += 1) {
+	    int64_t off = (int64_t)idx * 64 - shift;
+	    result.set_words(idx, plane_bits(that, false, off),
+			     plane_bits(that, true, off));
+      }
 
       return trim_vnum(result);
 }
@@ -1335,11 +1472,20 @@ verinum operator >> (const verinum&that, unsigned shift)
       }
 
       if (!has_len_flag) len -= shift;
-      verinum result(sign_bit, len, has_len_flag);
+      verinum result(verinum::V0, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < that.len() ;  idx += 1)
-	    result.set(idx-shift, that.get(idx));
+      for (unsigned idx = 0 ;  idx < result.nwords() ;  idx += 1) {
+	    int64_t off = (int64_t)idx * 64 + shift;
+	    result.set_words(idx, plane_bits(that, false, off),
+			     plane_bits(that, true, off));
+      }
+
+	// The bits shifted in at the top are the sign bit.
+      if (that.len() - shift < len && sign_bit != verinum::V0) {
+	    for (unsigned idx = that.len() - shift ;  idx < len ;  idx += 1)
+		  result.set(idx, sign_bit);
+      }
 
       return trim_vnum(result);
 }
@@ -1573,11 +1719,8 @@ verinum concat(const verinum&left, const verinum&right)
       }
 
       verinum res (verinum::V0, left.len() + right.len());
-      for (unsigned idx = 0 ;  idx < right.len() ;  idx += 1)
-	    res.set(idx, right.get(idx));
-
-      for (unsigned idx = 0 ;  idx < left.len() ;  idx += 1)
-	    res.set(idx+right.len(), left.get(idx));
+      res.set(0, right);
+      res.set(right.len(), left);
 
       return res;
 }
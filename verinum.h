@@ -35,6 +35,15 @@ using namespace std;
  * possible values: 0, 1, x or z. The verinum number is store in
  * little-endian format. This means that if the long value is 2b'10,
  * get(0) is 0 and get(1) is 1.
+ *
+ * The bits are packed 64 to a word in two planes. The a plane holds
+ * the low bit of the V value of each bit and the b plane holds the
+ * high bit, so 0 is a=0/b=0, 1 is a=1/b=0, x is a=0/b=1 and z is
+ * a=1/b=1. (This is not the vvp_bit4_t encoding, which has x and z
+ * the other way around.) A number with no x or z bits has a b plane
+ * of all zero, and the arithmetic works a word at a time on the a
+ * plane. The bits of the last word past len() are always zero in
+ * both planes.
  */
 class verinum {
 
@@ -100,6 +109,13 @@ class verinum {
 
       V operator[] (unsigned idx) const { return get(idx); }
 
+	// Access to the packed words. Word idx holds the bits from
+	// 64*idx up. set_words() clears the bits past len().
+      unsigned nwords() const { return (nbits_ + 63) / 64; }
+      uint64_t get_aword(unsigned idx) const { return abits_[idx]; }
+      uint64_t get_bword(unsigned idx) const { return bbits_[idx]; }
+      void set_words(unsigned idx, uint64_t a, uint64_t b);
+
 	// Return the value as a native unsigned integer. If the value is
 	// larger than can be represented by the returned type, return
 	// the maximum value of that type. If the value has any x or z
@@ -113,9 +129,13 @@ class verinum {
       string as_string() const;
     private:
       void signed_trim();
+      void allocate_(unsigned nbits);
+      void fill_(unsigned from, V val);
 
     private:
-      V* bits_;
+	// The a and b planes share one allocation.
+      uint64_t* abits_;
+      uint64_t* bbits_;
       unsigned nbits_;
       bool has_len_;
       bool has_sign_;
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include "config.h"
+
+/*
+ * This is a differential test of the verinum arithmetic. It runs a
+ * fixed pseudo-random sequence of cases through the verinum
+ * operators and prints every result. The printed text is hashed, and
+ * the hash at every CHECK_STRIDE cases is compared against the hash
+ * that the old bit-per-element implementation of verinum produced for
+ * the same sequence. A mismatch names the block of cases that went
+ * wrong; run "verinum_check -v" to get the full text of the results
+ * for comparison. "verinum_check -g" prints a fresh hash table.
+ */
+
+# include  "verinum.h"
+# include  <iostream>
+# include  <sstream>
+# include  <vector>
+# include  <cstring>
+
+static const unsigned CHECK_CASES = 20000;
+static const unsigned CHECK_STRIDE = 1000;
+
+/*
+ * These are the FNV-1a hashes of the output for cases 0 through
+ * N*CHECK_STRIDE-1, as produced by the original implementation.
+ */
+static const uint64_t expect_hash[CHECK_CASES/CHECK_STRIDE] = {
+      0x548ee2797974b705ULL,
+      0xca30a372003c97abULL,
+      0x9d51ada54d8347e9ULL,
+      0xc780e8487c1bd71eULL,
+      0x293d731aab42aaadULL,
+      0x9945945e1aa978bULL,
+      0xd086cdbb4a591a65ULL,
+      0xf3be6b14cbd5c6dcULL,
+      0x46a0d5f43fafd9e4ULL,
+      0x18a2b52ec990770bULL,
+      0x260611aa666dd58cULL,
+      0x7c077130114921e1ULL,
+      0x8009150821aee9f1ULL,
+      0xaf23e16c50a21165ULL,
+      0x75f1b2b6673b800ULL,
+      0xb84888bc238f2c6fULL,
+      0x40c0964847157f43ULL,
+      0x5dcb03407ce2c2b5ULL,
+      0x7dcc4db2ea83c0e9ULL,
+      0x47c8a02dcb917350ULL
+};
+
+static uint64_t rnd_state = 88172645463325252ULL;
+
+static unsigned rnd(void)
+{
+      rnd_state ^= rnd_state << 13;
+      rnd_state ^= rnd_state >> 7;
+      rnd_state ^= rnd_state << 17;
+      return (unsigned)rnd_state;
+}
+
+static verinum make_random(void)
+{
+      unsigned wid = (rnd()%4 == 0)? 1+rnd()%140 : 1+rnd()%70;
+      vector<verinum::V> bits (wid);
+      bool xz = rnd()%4 == 0;
+      for (unsigned idx = 0 ; idx < wid ; idx += 1) {
+	    unsigned r = rnd()%16;
+	    if (xz && r == 0)
+		  bits[idx] = verinum::Vx;
+	    else if (xz && r == 1)
+		  bits[idx] = verinum::Vz;
+	    else
+		  bits[idx] = (rnd()&1)? verinum::V1 : verinum::V0;
+      }
+      if (rnd()%5 == 0)
+	    for (unsigned idx = wid/2 ; idx < wid ; idx += 1)
+		  bits[idx] = verinum::V0;
+      if (rnd()%7 == 0)
+	    for (unsigned idx = wid/2 ; idx < wid ; idx += 1)
+		  bits[idx] = verinum::V1;
+
+      verinum val (&bits[0], wid, rnd()%3 != 0);
+      val.has_sign(rnd()&1);
+      return val;
+}
+
+static void print(ostream&out, const char*name, const verinum&val)
+{
+      out << name << " len=" << val.len() << " hl=" << val.has_len()
+	  << " s=" << val.has_sign() << " ";
+      for (unsigned idx = val.len() ; idx > 0 ; idx -= 1)
+	    out << val.get(idx-1);
+      out << " def=" << val.is_defined() << " z=" << val.is_zero()
+	  << " neg=" << val.is_negative()
+	  << " sb=" << val.significant_bits();
+      if (val.is_defined())
+	    out << " u64=" << val.as_ulong64() << " l=" << val.as_long()
+		<< " d=" << val.as_double();
+      out << " str=" << val << "\n";
+}
+
+static void run_case(ostream&out, unsigned num)
+{
+      verinum a = make_random();
+      verinum b = make_random();
+      out << "#" << num << "\n";
+      print(out, "a", a);
+      print(out, "b", b);
+
+      print(out, "add", a+b);
+      print(out, "sub", a-b);
+      print(out, "mul", a*b);
+      print(out, "neg", -a);
+      print(out, "not", ~a);
+      print(out, "div", a/b);
+      print(out, "mod", a%b);
+
+      unsigned sh = rnd()%150;
+      print(out, "shl", a<<sh);
+      print(out, "shr", a>>sh);
+
+      print(out, "cat", concat(a,b));
+      print(out, "trim", trim_vnum(a));
+      unsigned wid = 1+rnd()%150;
+      print(out, "cast", cast_to_width(a,wid));
+      print(out, "pad", pad_to_width(a,wid));
+      print(out, "cp", verinum(a, 1+rnd()%a.len()));
+
+      out << "eq" << (a==b) << " le" << (a<=b) << " lt" << (a<b)
+	  << " bef" << a.is_before(b) << "\n";
+
+      verinum c = a;
+      c.cast_to_int2();
+      print(out, "i2", c);
+
+      if (b.len() < 8) {
+	    verinum e = b;
+	    print(out, "pow", pow(a,e));
+      }
+
+      uint64_t u = ((uint64_t)rnd() << 32) | rnd();
+      unsigned ub = 1+rnd()%100;
+      print(out, "u64", verinum(u,ub));
+      print(out, "i64", verinum((int64_t)u));
+      print(out, "i64s", verinum((int64_t)(int)rnd()));
+      double d = (double)(int)rnd() / (1+rnd()%1000);
+      print(out, "dbl", verinum(d,false));
+
+      verinum f = a;
+      unsigned ix = rnd()%a.len();
+      f.set(ix, verinum::Vz);
+      print(out, "set", f);
+      if (b.len() <= a.len()) {
+	    verinum g = a;
+	    g.set(a.len()-b.len(), b);
+	    print(out, "setv", g);
+      }
+}
+
+int main(int argc, char*argv[])
+{
+      bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+      bool gen = argc > 1 && strcmp(argv[1], "-g") == 0;
+      unsigned errors = 0;
+      uint64_t hash = 0xcbf29ce484222325ULL;
+
+	// Some cases make verinum warn about truncation. That is
+	// expected, so keep it out of the test output.
+      ostringstream warnings;
+      streambuf*save_cerr = cerr.rdbuf(warnings.rdbuf());
+
+      for (unsigned num = 0 ; num < CHECK_CASES ; num += 1) {
+	    ostringstream out;
+	    run_case(out, num);
+	    warnings.str("");
+
+	    string text = out.str();
+	    for (size_t idx = 0 ; idx < text.size() ; idx += 1) {
+		  hash ^= (unsigned char)text[idx];
+		  hash *= 0x100000001b3ULL;
+	    }
+	    if (verbose)
+		  cout << text;
+
+	    if ((num+1) % CHECK_STRIDE != 0)
+		  continue;
+
+	    unsigned blk = num / CHECK_STRIDE;
+	    if (gen) {
+		  cout << "      0x" << hex << hash << dec << "ULL,\n";
+	    } else if (hash != expect_hash[blk]) {
+		  cout << "verinum_check: cases " << blk*CHECK_STRIDE
+		       << " to " << num << " differ.\n";
+		  errors += 1;
+	    }
+      }
+
+      cerr.rdbuf(save_cerr);
+
+      if (errors) return 1;
+      if (!verbose && !gen)
+	    cout << "verinum_check: " << CHECK_CASES << " cases match." << endl;
+      return 0;
+}
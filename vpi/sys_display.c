@@ -93,6 +93,8 @@ struct strobe_cb_info {
       vpiHandle*items;
       unsigned nitems;
       unsigned fd_mcd;
+	/* Precompiled constant format strings, indexed like items. */
+      struct format_prog_s**formats;
 };
 
 /*
@@ -146,6 +148,7 @@ static void array_from_iterator(struct strobe_cb_info*info, vpiHandle argv)
 		  free(items);
 		  info->nitems = 0;
 		  info->items  = 0;
+		  info->formats = 0;
 		  return;
 	    }
 
@@ -162,6 +165,7 @@ static void array_from_iterator(struct strobe_cb_info*info, vpiHandle argv)
 	    info->nitems = 0;
 	    info->items = 0;
       }
+      info->formats = 0;
 }
 
 static int get_default_format(const char *name)
@@ -880,58 +884,441 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
   return size - 1;
 }
 
-/* We can't use the normal str functions on the return value since
- * %u and %z can insert NULL characters into the stream. */
-static unsigned int get_format(char **rtn, char *fmt,
-                               const struct strobe_cb_info *info, unsigned int *idx)
+/*
+ * The display output is collected in a growable buffer. The $display
+ * style tasks keep one of these for the whole simulation, so a call
+ * does not need to allocate memory to build its output. The text is
+ * always '\0' terminated, but since %u and %z can insert NULL
+ * characters, len is the real length.
+ */
+struct display_buf_s {
+  char *text;
+  unsigned int len, alloc;
+};
+
+static void display_buf_reserve(struct display_buf_s *out, unsigned int cnt)
 {
-  char *cp = fmt;
-  unsigned int size;
+  if (out->len + cnt + 1 <= out->alloc) return;
+
+  if (out->alloc < 256) out->alloc = 256;
+  while (out->len + cnt + 1 > out->alloc) out->alloc *= 2;
+  out->text = realloc(out->text, out->alloc*sizeof(char));
+}
+
+static void display_buf_add(struct display_buf_s *out, const char *text,
+                            unsigned int cnt)
+{
+  display_buf_reserve(out, cnt);
+  memcpy(out->text+out->len, text, cnt);
+  out->len += cnt;
+  out->text[out->len] = '\0';
+}
+
+static void display_buf_fill(struct display_buf_s *out, char ch,
+                             unsigned int cnt)
+{
+  display_buf_reserve(out, cnt);
+  memset(out->text+out->len, ch, cnt);
+  out->len += cnt;
+  out->text[out->len] = '\0';
+}
+
+/* Add the text space padded to the given width, like the %*s and %-*s
+ * printf formats do. */
+static void display_buf_pad(struct display_buf_s *out, const char *text,
+                            int width, int ljust)
+{
+  unsigned int cnt = strlen(text);
+  unsigned int pad = (signed)cnt < width ? (unsigned)width - cnt : 0;
+
+  if (ljust == 0) display_buf_fill(out, ' ', pad);
+  display_buf_add(out, text, cnt);
+  if (ljust != 0) display_buf_fill(out, ' ', pad);
+}
+
+/*
+ * A format string is compiled into a list of segments, each of which
+ * is either a run of literal text or a single format specification.
+ * The constant format strings of a $display style call are compiled
+ * once and kept with the call, so later calls do not parse them again.
+ *
+ * Each format specification gets a converter when it is compiled. The
+ * common specifications (%b, %o, %h, %d, %s and %m with valid flags)
+ * have converters that fetch the value in the right format and write
+ * it straight to the output. Everything else, and every error case,
+ * goes through get_format_char().
+ */
+struct format_seg_s;
+typedef void (*format_conv_f)(struct display_buf_s *out,
+                              const struct format_seg_s *seg,
+                              const struct strobe_cb_info *info,
+                              unsigned int *idx);
+
+struct format_seg_s {
+  const char *text;  /* The literal text, or 0 for a format spec. */
+  unsigned int len;
+  int ljust, plus, ld_zero, width, prec;
+  char fmt;
+  format_conv_f conv;
+  PLI_INT32 vpi_format;  /* The value format used by conv. */
+};
+
+struct format_prog_s {
+  char *buf;  /* Holds the literal text of the segments. */
+  unsigned int nseg;
+  struct format_seg_s *seg;
+};
+
+static void format_generic(struct display_buf_s *out,
+                           const struct format_seg_s *seg,
+                           const struct strobe_cb_info *info,
+                           unsigned int *idx)
+{
+  char *result;
+  unsigned int cnt;
+
+  cnt = get_format_char(&result, seg->ljust, seg->plus, seg->ld_zero,
+                        seg->width, seg->prec, seg->fmt, info, idx);
+  display_buf_add(out, result, cnt);
+  free(result);
+}
+
+/* Get the value of the next argument in the format of the converter.
+ * This returns 0 if the argument is missing or the value can not be
+ * given in that format, and the caller then lets get_format_char()
+ * print the warning. */
+static vpiHandle format_get_value(s_vpi_value *value,
+                                  const struct format_seg_s *seg,
+                                  const struct strobe_cb_info *info,
+                                  unsigned int idx)
+{
+  vpiHandle item;
+
+  if (idx+1 >= info->nitems) return 0;
+  item = info->items[idx+1];
+  value->format = seg->vpi_format;
+  vpi_get_value(item, value);
+  if (value->format == vpiSuppressVal) return 0;
+  return item;
+}
+
+/* %b, %o and %h */
+static void format_radix(struct display_buf_s *out,
+                         const struct format_seg_s *seg,
+                         const struct strobe_cb_info *info,
+                         unsigned int *idx)
+{
+  s_vpi_value value;
+  const char *cp;
+  int width = seg->width;
+
+  if (! format_get_value(&value, seg, info, *idx)) {
+    format_generic(out, seg, info, idx);
+    return;
+  }
+  *idx += 1;
+
+  cp = value.value.str;
+  if (seg->ld_zero == 1) {
+    /* Strip the leading zeros if a width is not given or the value
+     * is left aligned, otherwise pad with leading zeros. */
+    if (width == -1 || seg->ljust != 0) {
+      while (*cp == '0' && *(cp+1) != '\0') cp++;
+    } else {
+      unsigned swidth = strlen(cp);
+      if ((signed)swidth < width) {
+        display_buf_fill(out, '0', (unsigned)width - swidth);
+        display_buf_add(out, cp, swidth);
+        return;
+      }
+    }
+  }
+
+  /* If a width was not given, use a width of zero. */
+  if (width == -1) width = 0;
+  display_buf_pad(out, cp, width, seg->ljust);
+}
+
+/* %d */
+static void format_dec(struct display_buf_s *out,
+                       const struct format_seg_s *seg,
+                       const struct strobe_cb_info *info,
+                       unsigned int *idx)
+{
+  s_vpi_value value;
+  vpiHandle item;
+  const char *cp;
+  char sign = 0;
+  unsigned int swidth, pad = 0;
+  int width = seg->width;
+
+  item = format_get_value(&value, seg, info, *idx);
+  if (! item) {
+    format_generic(out, seg, info, idx);
+    return;
+  }
+  *idx += 1;
+
+  cp = value.value.str;
+  if (*cp == '-') {
+    sign = '-';
+    cp += 1;
+  } else if (seg->plus == 1) sign = '+';
+  swidth = strlen(cp) + (sign ? 1 : 0);
+
+  if (seg->ljust == 0 && seg->ld_zero == 1 && (signed)swidth < width)
+    pad = (unsigned)width - swidth;
+
+  /* If a width was not given, use the default, unless we have a
+   * leading zero (width of zero). Because the width of a real in
+   * Icarus is 1 the string length will set the width of a real
+   * displayed using %d. */
+  if (width == -1) {
+    width = (seg->ld_zero == 1) ? 0 : vpi_get_dec_size(item);
+  }
+
+  swidth += pad;
+  if (seg->ljust == 0 && (signed)swidth < width)
+    display_buf_fill(out, ' ', (unsigned)width - swidth);
+  if (sign) display_buf_add(out, &sign, 1);
+  display_buf_fill(out, '0', pad);
+  display_buf_add(out, cp, strlen(cp));
+  if (seg->ljust != 0 && (signed)swidth < width)
+    display_buf_fill(out, ' ', (unsigned)width - swidth);
+}
 
-  *rtn = strdup("");
-  size = 1;
+/* %s */
+static void format_str(struct display_buf_s *out,
+                       const struct format_seg_s *seg,
+                       const struct strobe_cb_info *info,
+                       unsigned int *idx)
+{
+  s_vpi_value value;
+  vpiHandle item;
+  int width = seg->width;
+
+  item = format_get_value(&value, seg, info, *idx);
+  if (! item) {
+    format_generic(out, seg, info, idx);
+    return;
+  }
+  *idx += 1;
+
+  /* Strings are not numeric and are not zero filled, so %08s => %8s.
+   * If all we have is a leading zero then we want a zero width,
+   * otherwise if a width was not given, use the value width. */
+  if (width == -1) {
+    if (seg->ld_zero == 1) width = 0;
+    else width = (vpi_get(vpiSize, item)+7) / 8;
+  }
+  display_buf_pad(out, value.value.str, width, seg->ljust);
+}
+
+/* %m */
+static void format_scope(struct display_buf_s *out,
+                         const struct format_seg_s *seg,
+                         const struct strobe_cb_info *info,
+                         unsigned int *idx)
+{
+  (void)idx; /* Parameter is not used. */
+  display_buf_pad(out, vpi_get_str(vpiFullName, info->scope),
+                  seg->width == -1 ? 0 : seg->width, seg->ljust);
+}
+
+/* Pick the converter for a format specification. The flags that make
+ * get_format_char() print a warning are left to it. */
+static void select_format_conv(struct format_seg_s *seg)
+{
+  seg->conv = format_generic;
+  seg->vpi_format = 0;
+
+  switch (seg->fmt) {
+    case 'b':
+    case 'B':
+      seg->vpi_format = vpiBinStrVal;
+      break;
+    case 'o':
+    case 'O':
+      seg->vpi_format = vpiOctStrVal;
+      break;
+    case 'h':
+    case 'H':
+    case 'x':
+    case 'X':
+      seg->vpi_format = vpiHexStrVal;
+      break;
+    case 'd':
+    case 'D':
+      if (seg->prec == -1) {
+        seg->conv = format_dec;
+        seg->vpi_format = vpiDecStrVal;
+      }
+      return;
+    case 's':
+    case 'S':
+      if (seg->plus == 0 && seg->prec == -1) {
+        seg->conv = format_str;
+        seg->vpi_format = vpiStringVal;
+      }
+      return;
+    case 'm':
+    case 'M':
+      if (seg->plus == 0 && seg->prec == -1) seg->conv = format_scope;
+      return;
+    default:
+      return;
+  }
+
+  if (seg->plus == 0 && seg->prec == -1) seg->conv = format_radix;
+}
+
+static struct format_prog_s *compile_format(const char *fmt)
+{
+  struct format_prog_s *prog = malloc(sizeof(struct format_prog_s));
+  char *cp;
+
+  prog->buf = strdup(fmt);
+  prog->nseg = 0;
+  prog->seg = 0;
+
+  cp = prog->buf;
   while (*cp) {
+    struct format_seg_s *seg;
     size_t cnt = strcspn(cp, "%");
 
+    prog->seg = realloc(prog->seg, (prog->nseg+1)*sizeof(struct format_seg_s));
+    seg = prog->seg + prog->nseg;
+    prog->nseg += 1;
+
     if (cnt > 0) {
-      *rtn = realloc(*rtn, (size+cnt)*sizeof(char));
-      memcpy(*rtn+size-1, cp, cnt);
-      size += cnt;
+      seg->text = cp;
+      seg->len = cnt;
       cp += cnt;
+    } else if (cp[1] == '%') {
+      /* A plain %% is just literal text. */
+      seg->text = cp + 1;
+      seg->len = 1;
+      cp += 2;
     } else {
-      int ljust = 0, plus = 0, ld_zero = 0, width = -1, prec = -1;
-      char *result;
+      seg->text = 0;
+      seg->len = 0;
+      seg->ljust = 0;
+      seg->plus = 0;
+      seg->ld_zero = 0;
+      seg->width = -1;
+      seg->prec = -1;
 
       cp += 1;
       while ((*cp == '-') || (*cp == '+')) {
-        if (*cp == '-') ljust = 1;
-        else plus = 1;
+        if (*cp == '-') seg->ljust = 1;
+        else seg->plus = 1;
         cp += 1;
       }
       if (*cp == '0') {
-        ld_zero = 1;
+        seg->ld_zero = 1;
         cp += 1;
       }
-      if (isdigit((int)*cp)) width = strtoul(cp, &cp, 10);
+      if (isdigit((int)*cp)) seg->width = strtoul(cp, &cp, 10);
       if (*cp == '.') {
         cp += 1;
-        prec = strtoul(cp, &cp, 10);
+        seg->prec = strtoul(cp, &cp, 10);
       }
-      cnt = get_format_char(&result, ljust, plus, ld_zero, width, prec, *cp,
-                            info, idx);
-      *rtn = realloc(*rtn, (size+cnt)*sizeof(char));
-      memcpy(*rtn+size-1, result, cnt);
-      free(result);
-      size += cnt;
+      seg->fmt = *cp;
       if (*cp) cp += 1;
+      select_format_conv(seg);
     }
   }
-  *(*rtn+size-1) = '\0';
-  return size - 1;
+
+  return prog;
 }
 
-static unsigned int get_numeric(char **rtn, const struct strobe_cb_info *info,
-                                vpiHandle item)
+static void free_format(struct format_prog_s *prog)
+{
+  free(prog->seg);
+  free(prog->buf);
+  free(prog);
+}
+
+static void run_format(struct display_buf_s *out,
+                       const struct format_prog_s *prog,
+                       const struct strobe_cb_info *info, unsigned int *idx)
+{
+  unsigned int sdx;
+
+  for (sdx = 0; sdx < prog->nseg; sdx += 1) {
+    const struct format_seg_s *seg = prog->seg + sdx;
+
+    if (seg->text) display_buf_add(out, seg->text, seg->len);
+    else seg->conv(out, seg, info, idx);
+  }
+}
+
+static void format_into(struct display_buf_s *out, const char *fmt,
+                        const struct strobe_cb_info *info, unsigned int *idx)
+{
+  struct format_prog_s *prog = compile_format(fmt);
+  run_format(out, prog, info, idx);
+  free_format(prog);
+}
+
+/* We can't use the normal str functions on the return value since
+ * %u and %z can insert NULL characters into the stream. */
+static unsigned int get_format(char **rtn, const char *fmt,
+                               const struct strobe_cb_info *info, unsigned int *idx)
+{
+  struct display_buf_s out = { 0, 0, 0 };
+
+  display_buf_reserve(&out, 0);
+  out.text[0] = '\0';
+  format_into(&out, fmt, info, idx);
+  *rtn = out.text;
+  return out.len;
+}
+
+/*
+ * Compile the constant format strings in the argument list. These are
+ * string constants and parameters, whose value can not change.
+ */
+static void compile_formats(struct strobe_cb_info *info)
+{
+  unsigned int idx;
+
+  if (info->nitems == 0) return;
+
+  info->formats = calloc(info->nitems, sizeof(struct format_prog_s*));
+  for (idx = 0; idx < info->nitems; idx += 1) {
+    vpiHandle item = info->items[idx];
+    s_vpi_value value;
+
+    switch (vpi_get(vpiType, item)) {
+      case vpiConstant:
+      case vpiParameter:
+        if (vpi_get(vpiConstType, item) == vpiStringConst) {
+          value.format = vpiStringVal;
+          vpi_get_value(item, &value);
+          info->formats[idx] = compile_format(value.value.str);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+static void free_formats(struct strobe_cb_info *info)
+{
+  unsigned int idx;
+
+  if (info->formats == 0) return;
+  for (idx = 0; idx < info->nitems; idx += 1) {
+    if (info->formats[idx]) free_format(info->formats[idx]);
+  }
+  free(info->formats);
+  info->formats = 0;
+}
+
+static void get_numeric(struct display_buf_s *out,
+                        const struct strobe_cb_info *info, vpiHandle item)
 {
   int size, min;
   s_vpi_value val;
@@ -947,28 +1334,45 @@ static unsigned int get_numeric(char **rtn, const struct strobe_cb_info *info,
 	 * the string width the minimum display width. */
       min = strlen(val.value.str);
       if (size < min) size = min;
-      *rtn = malloc((size+1)*sizeof(char));
-      sprintf(*rtn, "%*s", size, val.value.str);
+      display_buf_pad(out, val.value.str, size, 0);
       break;
     default:
-      *rtn = strdup(val.value.str);
+      display_buf_add(out, val.value.str, strlen(val.value.str));
   }
+}
+
+static void add_real(struct display_buf_s *out, double value)
+{
+  char buf[256];
 
-  return strlen(*rtn);
+#if !defined(__GNUC__)
+  if (compatible_flag)
+    sprintf(buf, "%g", value);
+  else {
+    if (value == 0.0 || value == -0.0)
+      sprintf(buf, "%.05f", value);
+    else
+      sprintf(buf, "%#g", value);
+  }
+#else
+  sprintf(buf, compatible_flag ? "%g" : "%#g", value);
+#endif
+  display_buf_add(out, buf, strlen(buf));
 }
 
-/* In many places we can't use the normal str functions since %u and %z
- * can insert NULL characters into the stream. */
-static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
+/* Add the display text of the items to the output buffer. In many
+ * places we can't use the normal str functions since %u and %z can
+ * insert NULL characters into the stream. */
+static void get_display_into(struct display_buf_s *out,
+                             const struct strobe_cb_info *info)
 {
-  char *result, *fmt, *rtn, *func_name;
-  const char *cresult;
+  char *func_name;
   s_vpi_value value;
-  unsigned int idx, size, width;
+  unsigned int idx;
   char buf[256];
 
-  rtn = strdup("");
-  size = 1;
+  display_buf_reserve(out, 0);
+  out->text[out->len] = '\0';
   for  (idx = 0; idx < info->nitems; idx += 1) {
     vpiHandle item = info->items[idx];
 
@@ -976,35 +1380,19 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
 
       case vpiConstant:
       case vpiParameter:
-        if (vpi_get(vpiConstType, item) == vpiStringConst) {
+        if (info->formats && info->formats[idx]) {
+          run_format(out, info->formats[idx], info, &idx);
+        } else if (vpi_get(vpiConstType, item) == vpiStringConst) {
           value.format = vpiStringVal;
           vpi_get_value(item, &value);
-          fmt = strdup(value.value.str);
-          width = get_format(&result, fmt, info, &idx);
-          free(fmt);
+          format_into(out, value.value.str, info, &idx);
         } else if (vpi_get(vpiConstType, item) == vpiRealConst) {
           value.format = vpiRealVal;
           vpi_get_value(item, &value);
-#if !defined(__GNUC__)
-		  if(compatible_flag)
-			  sprintf(buf, "%g", value.value.real);
-		  else {
-			  if(value.value.real == 0.0 || value.value.real == -0.0)
-				  sprintf(buf, "%.05f", value.value.real);
-			  else
-				  sprintf(buf, "%#g", value.value.real);
-		  }
-#else
-          sprintf(buf, compatible_flag ? "%g" : "%#g", value.value.real);
-#endif
-          result = strdup(buf);
-          width = strlen(result);
+          add_real(out, value.value.real);
         } else {
-          width = get_numeric(&result, info, item);
+          get_numeric(out, info, item);
         }
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, result, width);
-        free(result);
         break;
 
       case vpiNet:
@@ -1017,10 +1405,7 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
       case vpiIntegerVar:
       case vpiMemoryWord:
       case vpiPartSelect:
-        width = get_numeric(&result, info, item);
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, result, width);
-        free(result);
+        get_numeric(out, info, item);
         break;
 
       /* It appears that this is not currently used! A time variable is
@@ -1031,31 +1416,14 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
         vpi_get_value(item, &value);
         get_time(buf, value.value.str, timeformat_info.prec,
                  vpi_get(vpiTimeUnit, info->scope));
-        width = strlen(buf);
-        if (width  < timeformat_info.width) width = timeformat_info.width;
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        sprintf(rtn+size-1, "%*s", width, buf);
+        display_buf_pad(out, buf, timeformat_info.width, 0);
         break;
 
       /* Realtime variables are also processed here. */
       case vpiRealVar:
         value.format = vpiRealVal;
         vpi_get_value(item, &value);
-#if !defined(__GNUC__)
-		if (compatible_flag)
-			sprintf(buf, "%g", value.value.real);
-		else {
-			if (value.value.real == 0.0 || value.value.real == -0.0)
-				sprintf(buf, "%.05f", value.value.real);
-			else
-				sprintf(buf, "%#g", value.value.real);
-		}
-#else
-        sprintf(buf, compatible_flag ? "%g" : "%#g", value.value.real);
-#endif
-        width = strlen(buf);
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, buf, width);
+        add_real(out, value.value.real);
         break;
 
        /* Process string variables like string constants: interpret
@@ -1063,12 +1431,7 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
       case vpiStringVar:
 	value.format = vpiStringVal;
 	vpi_get_value(item, &value);
-	fmt = strdup(value.value.str);
-	width = get_format(&result, fmt, info, &idx);
-	free(fmt);
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, result, width);
-        free(result);
+	format_into(out, value.value.str, info, &idx);
 	break;
 
       case vpiSysFuncCall:
@@ -1076,26 +1439,17 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
         if (strcmp(func_name, "$time") == 0) {
           value.format = vpiDecStrVal;
           vpi_get_value(item, &value);
-          width = strlen(value.value.str);
-          if (width  < 20) width = 20;
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          sprintf(rtn+size-1, "%*s", width, value.value.str);
+          display_buf_pad(out, value.value.str, 20, 0);
 
         } else if (strcmp(func_name, "$stime") == 0) {
           value.format = vpiDecStrVal;
           vpi_get_value(item, &value);
-          width = strlen(value.value.str);
-          if (width  < 10) width = 10;
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          sprintf(rtn+size-1, "%*s", width, value.value.str);
+          display_buf_pad(out, value.value.str, 10, 0);
 
         } else if (strcmp(func_name, "$simtime") == 0) {
           value.format = vpiDecStrVal;
           vpi_get_value(item, &value);
-          width = strlen(value.value.str);
-          if (width  < 20) width = 20;
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          sprintf(rtn+size-1, "%*s", width, value.value.str);
+          display_buf_pad(out, value.value.str, 20, 0);
 
         } else if (strcmp(func_name, "$realtime") == 0) {
           /* Use the local scope precision. */
@@ -1105,17 +1459,12 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
           value.format = vpiRealVal;
           vpi_get_value(item, &value);
           sprintf(buf, "%.*f", use_prec, value.value.real);
-          width = strlen(buf);
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          sprintf(rtn+size-1, "%*s", width, buf);
+          display_buf_add(out, buf, strlen(buf));
 
         } else {
           vpi_printf("WARNING: %s:%d: %s does not support %s as an argument!\n",
                      info->filename, info->lineno, info->name, func_name);
-          strcpy(buf, "<?>");
-          width = strlen(buf);
-          rtn = realloc(rtn, (size+width)*sizeof(char));
-          memcpy(rtn+size-1, buf, width);
+          display_buf_add(out, "<?>", 3);
         }
         break;
 
@@ -1123,17 +1472,22 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
         vpi_printf("WARNING: %s:%d: unknown argument type (%s) given to %s!\n",
                    info->filename, info->lineno, vpi_get_str(vpiType, item),
                    info->name);
-        cresult = "<?>";
-        width = strlen(cresult);
-        rtn = realloc(rtn, (size+width)*sizeof(char));
-        memcpy(rtn+size-1, cresult, width);
+        display_buf_add(out, "<?>", 3);
         break;
     }
-    size += width;
   }
-  rtn[size-1] = '\0';
-  *rtnsz = size - 1;
-  return rtn;
+}
+
+/* The caller needs to free the returned string. Because %u and %z may
+ * put embedded NULL characters into the returned string, strlen() may
+ * not match the real size! */
+static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
+{
+  struct display_buf_s out = { 0, 0, 0 };
+
+  get_display_into(&out, info);
+  *rtnsz = out.len;
+  return out.text;
 }
 
 #ifdef BR916_STOPGAP_FIX
@@ -1269,33 +1623,99 @@ static PLI_INT32 sys_display_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return sys_common_compiletf(name, 0, 0);
 }
 
+/*
+ * The $display style tasks keep the argument list and the compiled
+ * constant format strings of each call with the call handle. This
+ * is built the first time the call is executed, and saves scanning
+ * the arguments and parsing the format strings on every later call.
+ * The saved calls are freed at the end of the simulation.
+ */
+struct display_call_s {
+      vpiHandle callh;
+      vpiHandle fd_mcd_arg;
+      struct strobe_cb_info info;
+      struct display_call_s*next;
+};
+
+  /* All the saved calls, so they can be freed at the end of the
+   * simulation. */
+static struct display_call_s*display_call_list = 0;
+
+  /* The output of a $display style call is built here. */
+static struct display_buf_s display_out = { 0, 0, 0 };
+
+static struct display_call_s*get_display_call(vpiHandle callh,
+                                              const char*name)
+{
+      struct display_call_s*call;
+      vpiHandle argv;
+
+      call = (struct display_call_s*)vpi_get_userdata(callh);
+      if (call) return call;
+
+      call = malloc(sizeof(struct display_call_s));
+      call->callh = callh;
+      argv = vpi_iterate(vpiArgument, callh);
+
+	/* The file/MC descriptor is the first argument, if any. */
+      if (name[1] == 'f') call->fd_mcd_arg = vpi_scan(argv);
+      else call->fd_mcd_arg = 0;
+
+	/* We could use vpi_get_str(vpiName, callh) to get the task name,
+	 * but name is already defined. */
+      call->info.name = name;
+      call->info.filename = strdup(vpi_get_str(vpiFile, callh));
+      call->info.lineno = (int)vpi_get(vpiLineNo, callh);
+      call->info.default_format = get_default_format(name);
+      call->info.scope = vpi_handle(vpiScope, callh);
+      assert(call->info.scope);
+      array_from_iterator(&call->info, argv);
+      compile_formats(&call->info);
+
+      call->next = display_call_list;
+      display_call_list = call;
+      vpi_put_userdata(callh, call);
+      return call;
+}
+
+static void free_display_calls(void)
+{
+      while (display_call_list) {
+	    struct display_call_s*call = display_call_list;
+	    display_call_list = call->next;
+	    vpi_put_userdata(call->callh, 0);
+	    free_formats(&call->info);
+	    free(call->info.filename);
+	    free(call->info.items);
+	    free(call);
+      }
+      free(display_out.text);
+      display_out.text = 0;
+      display_out.len = 0;
+      display_out.alloc = 0;
+}
+
 /* This implements the $sformatf, $display/$fdisplay
  * and the $write/$fwrite based tasks. */
 static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 {
-      vpiHandle callh, argv, scope;
-      struct strobe_cb_info info;
-      char* result;
-      unsigned int size;
+      vpiHandle callh;
+      struct display_call_s*call;
       PLI_UINT32 fd_mcd;
       s_vpi_value val;
 
       callh = vpi_handle(vpiSysTfCall, 0);
-      argv = vpi_iterate(vpiArgument, callh);
+      call = get_display_call(callh, name);
 
 	/* Get the file/MC descriptor and verify it is valid. */
       if(name[1] == 'f') {
 	      errno = 0;
-	      vpiHandle arg = vpi_scan(argv);
 	      val.format = vpiIntVal;
-	      vpi_get_value(arg, &val);
+	      vpi_get_value(call->fd_mcd_arg, &val);
 	      fd_mcd = val.value.integer;
 
 		/* If the MCD is zero we have nothing to do so just return. */
-	      if (fd_mcd == 0)  {
-		    vpi_free_object(argv);
-		    return 0;
-	      }
+	      if (fd_mcd == 0) return 0;
 
 	      if ((! IS_MCD(fd_mcd) && vpi_get_file(fd_mcd) == NULL) ||
 	          ( IS_MCD(fd_mcd) && my_mcd_printf(fd_mcd, "") == EOF)) {
@@ -1304,7 +1724,6 @@ static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 		    vpi_printf("invalid file descriptor/MCD (0x%x) given "
 		               "to %s.\n", (unsigned int)fd_mcd, name);
 		    errno = EBADF;
-		    vpi_free_object(argv);
 		    return 0;
 	      }
       } else if(strncmp(name,"$sformatf",9) == 0) {
@@ -1315,35 +1734,22 @@ static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 	      fd_mcd = 1;
       }
 
-      scope = vpi_handle(vpiScope, callh);
-      assert(scope);
-	/* We could use vpi_get_str(vpiName, callh) to get the task name,
-	 * but name is already defined. */
-      info.name = name;
-      info.filename = strdup(vpi_get_str(vpiFile, callh));
-      info.lineno = (int)vpi_get(vpiLineNo, callh);
-      info.default_format = get_default_format(name);
-      info.scope = scope;
-      array_from_iterator(&info, argv);
-
 	/* Because %u and %z may put embedded NULL characters into the
-	 * returned string strlen() may not match the real size! */
-      result = get_display(&size, &info);
+	 * output, strlen() may not match the real size! */
+      display_out.len = 0;
+      get_display_into(&display_out, &call->info);
 
       if(fd_mcd > 0) {
-	      my_mcd_rawwrite(fd_mcd, result, size);
+	      my_mcd_rawwrite(fd_mcd, display_out.text, display_out.len);
 	      if ((strncmp(name,"$display",8) == 0) ||
 	          (strncmp(name,"$fdisplay",9) == 0)) my_mcd_rawwrite(fd_mcd, "\n", 1);
       } else {
 	      /* Return as a string ($sformatf) */
 	      val.format = vpiStringVal;
-	      val.value.str = result;
+	      val.value.str = display_out.text;
 	      vpi_put_value(callh, &val, 0, vpiNoDelay);
       }
 
-      free(result);
-      free(info.filename);
-      free(info.items);
       return 0;
 }
 
@@ -1463,7 +1869,7 @@ static PLI_INT32 sys_strobe_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
  * though that monitor may be watching many variables).
  */
 
-static struct strobe_cb_info monitor_info = { 0, 0, 0, 0, 0, 0, 0, 0 };
+static struct strobe_cb_info monitor_info = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 static vpiHandle *monitor_callbacks = 0;
 static int monitor_scheduled = 0;
 static int monitor_enabled = 1;
@@ -2181,6 +2587,8 @@ static PLI_INT32 sys_end_of_simulation(p_cb_data cb_data)
 
       free(timeformat_info.suff);
       timeformat_info.suff = 0;
+
+      free_display_calls();
       return 0;
 }
 
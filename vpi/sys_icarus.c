@@ -67,6 +67,97 @@ static PLI_INT32 missing_optional_compiletf(ICARUS_VPI_CONST PLI_BYTE8* name)
       return 0;
 }
 
+/*
+ * $icarus_activity(signal) returns the number of value updates of the
+ * signal counted so far. The counting is only done when vvp is run
+ * with -T, otherwise this always returns zero.
+ */
+static PLI_INT32 icarus_activity_compiletf(ICARUS_VPI_CONST PLI_BYTE8* name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg;
+
+      if (argv == 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s requires a single net or variable argument.\n",
+	               name);
+	    vpi_control(vpiFinish, 1);
+	    return 0;
+      }
+
+      arg = vpi_scan(argv);
+      switch (vpi_get(vpiType, arg)) {
+	  case vpiNet:
+	  case vpiReg:
+	  case vpiIntegerVar:
+	  case vpiTimeVar:
+	  case vpiRealVar:
+	  case vpiBitVar:
+	  case vpiByteVar:
+	  case vpiShortIntVar:
+	  case vpiIntVar:
+	  case vpiLongIntVar:
+	    break;
+	  default:
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's argument must be a net or variable.\n", name);
+	    vpi_control(vpiFinish, 1);
+	    break;
+      }
+
+      check_for_extra_args(argv, callh, name,
+                           "a single net or variable argument", 0);
+
+      return 0;
+}
+
+static PLI_INT32 icarus_activity_calltf(ICARUS_VPI_CONST PLI_BYTE8* name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg = vpi_scan(argv);
+      s_vpi_value val;
+      (void) name;  /* Not used! */
+
+      vpi_free_object(argv);
+
+      val.format = vpiIntVal;
+      val.value.integer = vpi_get(_vpiActivity, arg);
+      vpi_put_value(callh, &val, 0, vpiNoDelay);
+
+      return 0;
+}
+
+/*
+ * $icarus_stats(file) writes the run time statistics as a JSON object
+ * to the file, the same as the -stats=<file> extended argument does at
+ * the end of the simulation.
+ */
+static PLI_INT32 icarus_stats_calltf(ICARUS_VPI_CONST PLI_BYTE8* name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg = vpi_scan(argv);
+      s_vpi_value val;
+
+      vpi_free_object(argv);
+
+      val.format = vpiStringVal;
+      vpi_get_value(arg, &val);
+
+      if (! vpip_write_stats(val.value.str)) {
+	    vpi_printf("WARNING: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s could not write \"%s\".\n", name,
+	               val.value.str);
+      }
+
+      return 0;
+}
+
 /*
  * Register the function with Verilog.
  */
@@ -75,6 +166,25 @@ void sys_special_register(void)
       s_vpi_systf_data tf_data;
       vpiHandle res;
 
+      tf_data.type        = vpiSysTask;
+      tf_data.calltf      = icarus_stats_calltf;
+      tf_data.compiletf   = sys_one_string_arg_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.tfname      = "$icarus_stats";
+      tf_data.user_data   = "$icarus_stats";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      tf_data.type        = vpiSysFunc;
+      tf_data.sysfunctype = vpiSysFuncInt;
+      tf_data.calltf      = icarus_activity_calltf;
+      tf_data.compiletf   = icarus_activity_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.tfname      = "$icarus_activity";
+      tf_data.user_data   = "$icarus_activity";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
       tf_data.type        = vpiSysTask;
       tf_data.calltf      = finish_and_return_calltf;
       tf_data.compiletf   = sys_one_numeric_arg_compiletf;
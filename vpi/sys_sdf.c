@@ -19,9 +19,11 @@
 
 # include  "sys_priv.h"
 # include  "sdf_priv.h"
+# include  "stringheap.h"
 # include  <stdlib.h>
 # include  <string.h>
 # include  <assert.h>
+# include  "ivl_alloc.h"
 
 /*
  * These are static context
@@ -37,23 +39,165 @@ static vpiHandle sdf_callh = 0;
   /* The cell in process. */
 static vpiHandle sdf_cur_cell;
 
-static vpiHandle find_scope(vpiHandle scope, const char*name)
+/*
+ * The module hierarchy below the annotation scope is indexed once per
+ * $sdf_annotate call so that each CELL instance can be found without
+ * scanning all the children of every scope in its path. The index is
+ * a table of (parent, name, child) entries sorted by parent and name
+ * that is searched with bsearch.
+ */
+struct sdf_scope_entry_s {
+      vpiHandle parent;
+      const char*name;
+      vpiHandle scope;
+};
+
+static struct sdf_scope_entry_s*scope_tab = 0;
+static unsigned scope_tab_cnt = 0;
+static unsigned scope_tab_size = 0;
+static int scope_tab_valid = 0;
+static struct stringheap_s scope_name_heap = {0, 0};
+
+static int scope_entry_compare(const void*a, const void*b)
 {
-      vpiHandle idx = vpi_iterate(vpiModule, scope);
-	/* If this scope has no modules then it can't have the one we
-	 * are looking for so just return 0. */
-      if (idx == 0) return 0;
+      const struct sdf_scope_entry_s*ea = (const struct sdf_scope_entry_s*)a;
+      const struct sdf_scope_entry_s*eb = (const struct sdf_scope_entry_s*)b;
+
+      if (ea->parent < eb->parent) return -1;
+      if (ea->parent > eb->parent) return 1;
+      return strcmp(ea->name, eb->name);
+}
 
+static void scope_tab_add_children(vpiHandle parent)
+{
+      vpiHandle idx = vpi_iterate(vpiModule, parent);
       vpiHandle cur;
+
+      if (idx == 0) return;
+
       while ( (cur = vpi_scan(idx)) ) {
+	    if (scope_tab_cnt == scope_tab_size) {
+		  scope_tab_size = scope_tab_size? 2*scope_tab_size : 256;
+		  scope_tab = (struct sdf_scope_entry_s*)
+			realloc(scope_tab, scope_tab_size*sizeof(*scope_tab));
+	    }
+	    scope_tab[scope_tab_cnt].parent = parent;
+	    scope_tab[scope_tab_cnt].name = strdup_sh(&scope_name_heap,
+						vpi_get_str(vpiName, cur));
+	    scope_tab[scope_tab_cnt].scope = cur;
+	    scope_tab_cnt += 1;
+
+	    scope_tab_add_children(cur);
+      }
+}
+
+static void scope_tab_delete(void)
+{
+      free(scope_tab);
+      scope_tab = 0;
+      scope_tab_cnt = 0;
+      scope_tab_size = 0;
+      scope_tab_valid = 0;
+      string_heap_delete(&scope_name_heap);
+}
+
+static vpiHandle find_scope(vpiHandle scope, const char*name)
+{
+      struct sdf_scope_entry_s key, *res;
+
+      if (! scope_tab_valid) {
+	    scope_tab_add_children(sdf_scope);
+	    qsort(scope_tab, scope_tab_cnt, sizeof(*scope_tab),
+		  scope_entry_compare);
+	    scope_tab_valid = 1;
+      }
 
-	    if ( strcmp(name, vpi_get_str(vpiName,cur)) == 0) {
-		  vpi_free_object(idx);
-		  return cur;
+      key.parent = scope;
+      key.name = name;
+      key.scope = 0;
+      res = (struct sdf_scope_entry_s*)
+	    bsearch(&key, scope_tab, scope_tab_cnt, sizeof(*scope_tab),
+		    scope_entry_compare);
+
+      return res? res->scope : 0;
+}
+
+/*
+ * The modpaths of the current cell are likewise collected into a
+ * table sorted by source and destination port name the first time an
+ * IOPATH refers to the cell, so that each IOPATH only has to look at
+ * the modpaths that connect its ports.
+ */
+struct sdf_path_entry_s {
+      const char*src;
+      const char*dst;
+      int edge;
+      vpiHandle path;
+};
+
+static struct sdf_path_entry_s*path_tab = 0;
+static unsigned path_tab_cnt = 0;
+static vpiHandle path_tab_cell = 0;
+static struct stringheap_s path_name_heap = {0, 0};
+
+static int path_entry_compare(const void*a, const void*b)
+{
+      const struct sdf_path_entry_s*ea = (const struct sdf_path_entry_s*)a;
+      const struct sdf_path_entry_s*eb = (const struct sdf_path_entry_s*)b;
+      int rc = strcmp(ea->src, eb->src);
+
+      if (rc != 0) return rc;
+      return strcmp(ea->dst, eb->dst);
+}
+
+static void path_tab_delete(void)
+{
+      free(path_tab);
+      path_tab = 0;
+      path_tab_cnt = 0;
+      path_tab_cell = 0;
+      string_heap_delete(&path_name_heap);
+}
+
+static void path_tab_build(vpiHandle cell)
+{
+      vpiHandle iter, path;
+      unsigned size = 0;
+
+      path_tab_delete();
+      path_tab_cell = cell;
+
+      iter = vpi_iterate(vpiModPath, cell);
+      if (iter == 0) return;
+
+      while ( (path = vpi_scan(iter)) ) {
+	    vpiHandle path_t_in = vpi_handle(vpiModPathIn,path);
+	    vpiHandle path_t_out = vpi_handle(vpiModPathOut,path);
+
+	    vpiHandle path_in = vpi_handle(vpiExpr,path_t_in);
+	    vpiHandle path_out = vpi_handle(vpiExpr,path_t_out);
+
+	      /* The expressions for the path terms must be signals,
+	         vpiNet or vpiReg. */
+	    assert(vpi_get(vpiType,path_in) == vpiNet);
+	    assert(vpi_get(vpiType,path_out) == vpiNet
+		   || vpi_get(vpiType,path_out) == vpiReg);
+
+	    if (path_tab_cnt == size) {
+		  size = size? 2*size : 16;
+		  path_tab = (struct sdf_path_entry_s*)
+			realloc(path_tab, size*sizeof(*path_tab));
 	    }
+	    path_tab[path_tab_cnt].src = strdup_sh(&path_name_heap,
+					      vpi_get_str(vpiName,path_in));
+	    path_tab[path_tab_cnt].dst = strdup_sh(&path_name_heap,
+					      vpi_get_str(vpiName,path_out));
+	    path_tab[path_tab_cnt].edge = vpi_get(vpiEdge,path_t_in);
+	    path_tab[path_tab_cnt].path = path;
+	    path_tab_cnt += 1;
       }
 
-      return 0;
+      qsort(path_tab, path_tab_cnt, sizeof(*path_tab), path_entry_compare);
 }
 
 /*
@@ -138,46 +282,41 @@ static const char*edge_str(int vpi_edge)
 void sdf_iopath_delays(int vpi_edge, const char*src, const char*dst,
 		       const struct sdf_delval_list_s*delval_list)
 {
-      vpiHandle iter, path;
+      struct sdf_path_entry_s key, *cur, *end;
       int match_count = 0;
 
       if (sdf_cur_cell == 0)
 	    return;
 
-      iter = vpi_iterate(vpiModPath, sdf_cur_cell);
+      if (path_tab_cell != sdf_cur_cell)
+	    path_tab_build(sdf_cur_cell);
 
-	/* Search for the modpath that matches the IOPATH by looking
-	   for the modpath that uses the same ports as the ports that
+	/* Search for the modpaths that match the IOPATH by looking
+	   for the modpaths that use the same ports as the ports that
 	   the parser has found. */
-      if (iter) while ( (path = vpi_scan(iter)) ) {
+      key.src = src;
+      key.dst = dst;
+      cur = (struct sdf_path_entry_s*)
+	    bsearch(&key, path_tab, path_tab_cnt, sizeof(*path_tab),
+		    path_entry_compare);
+
+	/* There may be several modpaths with the same ports, so back
+	   up to the first and then scan through all of them. */
+      end = path_tab + path_tab_cnt;
+      if (cur) while (cur > path_tab && path_entry_compare(cur-1, &key) == 0)
+	    cur -= 1;
+
+      if (cur) for ( ; cur < end && path_entry_compare(cur, &key) == 0
+		       ; cur += 1) {
 	    s_vpi_delay delays;
 	    struct t_vpi_time delay_vals[12];
 	    int idx;
 
-	    vpiHandle path_t_in = vpi_handle(vpiModPathIn,path);
-	    vpiHandle path_t_out = vpi_handle(vpiModPathOut,path);
-
-	    vpiHandle path_in = vpi_handle(vpiExpr,path_t_in);
-	    vpiHandle path_out = vpi_handle(vpiExpr,path_t_out);
-
-	      /* The expressions for the path terms must be signals,
-	         vpiNet or vpiReg. */
-	    assert(vpi_get(vpiType,path_in) == vpiNet);
-	    assert(vpi_get(vpiType,path_out) == vpiNet
-		   || vpi_get(vpiType,path_out) == vpiReg);
-
-	      /* If the src name doesn't match, go on. */
-	    if (strcmp(src,vpi_get_str(vpiName,path_in)) != 0)
-		  continue;
-	      /* The edge type must match too. But note that if this
+	      /* The edge type must match. But note that if this
 	         IOPATH has no edge, then it matches with all edges of
 	         the modpath object. */
 /* --> Is this correct in the context of the 10, 01, etc. edges? */
-	    if (vpi_edge != vpiNoEdge && vpi_get(vpiEdge,path_t_in) != vpi_edge)
-		  continue;
-
-	      /* If the dst name doesn't match, go on. */
-	    if (strcmp(dst,vpi_get_str(vpiName,path_out)) != 0)
+	    if (vpi_edge != vpiNoEdge && cur->edge != vpi_edge)
 		  continue;
 
 	      /* Ah, this must be a match! */
@@ -187,7 +326,7 @@ void sdf_iopath_delays(int vpi_edge, const char*src, const char*dst,
 	    delays.mtm_flag = 0;
 	    delays.append_flag = 0;
 	    delays.plusere_flag = 0;
-	    vpi_get_delays(path, &delays);
+	    vpi_get_delays(cur->path, &delays);
 
 	    for (idx = 0 ; idx < delval_list->count ; idx += 1) {
 		  delay_vals[idx].type = vpiScaledRealTime;
@@ -196,7 +335,7 @@ void sdf_iopath_delays(int vpi_edge, const char*src, const char*dst,
 		  }
 	    }
 
-	    vpi_put_delays(path, &delays);
+	    vpi_put_delays(cur->path, &delays);
 	    match_count += 1;
       }
 
@@ -313,6 +452,11 @@ static PLI_INT32 sys_sdf_annotate_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       sdf_process_file(sdf_fd, fname);
       sdf_callh = 0;
 
+	/* The design may change before the next $sdf_annotate, so
+	   release the indexes built for this one. */
+      scope_tab_delete();
+      path_tab_delete();
+
       fclose(sdf_fd);
       free(fname);
       return 0;
@@ -401,6 +401,7 @@ typedef struct t_vpi_delay  {
 #  define _vpiDelaySelMaximum 3
 /* used in vvp/vpi_priv.h  0x1000003 */
 /* used in vvp/vpi_priv.h  0x1000004 */
+#define _vpiActivity       0x1000005
 
 /* DELAY MODES */
 #define vpiNoDelay            1
@@ -632,6 +633,10 @@ extern void vpip_set_return_value(int value);
 extern s_vpi_vecval vpip_calc_clog2(vpiHandle arg);
 extern void vpip_make_systf_system_defined(vpiHandle ref);
 
+  /* Write the run time statistics as JSON to the file path ("-" is
+     stdout). Returns 1 on success and 0 if the file can not be written. */
+extern PLI_INT32 vpip_write_stats(const char*path);
+
   /* Perform fwrite to mcd files. This is used to write raw data,
      which may include nulls. */
 extern void vpip_mcd_rawwrite(PLI_UINT32 mcd, const char*buf, size_t count);
@@ -290,6 +290,12 @@ struct vvp_code_s {
  */
 extern void codespace_init(void);
 
+/*
+ * Return the mnemonic of the opcode, or 0 if it is not known. This is
+ * a linear search, so it is only for reports.
+ */
+extern const char* vvp_opcode_mnemonic(vvp_code_fun opcode);
+
 
 /*
  * This function returns a pointer to the next free instruction in the
@@ -302,4 +308,10 @@ extern vvp_code_t codespace_allocate(void);
 extern vvp_code_t codespace_next(void);
 extern vvp_code_t codespace_null(void);
 
+/*
+ * The code space is allocated in chunks of this many instructions.
+ * The last instruction of each chunk is a %chunk_link to the next.
+ */
+extern const unsigned code_chunk_size;
+
 #endif /* IVL_codes_H */
@@ -34,6 +34,9 @@
 # include  "schedule.h"
 # include  <iostream>
 # include  <list>
+# include  <map>
+# include  <string>
+# include  <ctime>
 # include  <cstdlib>
 # include  <cstring>
 # include  <cassert>
@@ -306,6 +309,15 @@ static const struct opcode_table_s opcode_table[] = {
 static const unsigned opcode_count =
                     sizeof(opcode_table)/sizeof(*opcode_table) - 1;
 
+const char* vvp_opcode_mnemonic(vvp_code_fun opcode)
+{
+      for (unsigned idx = 0 ;  idx < opcode_count ;  idx += 1) {
+	    if (opcode_table[idx].opcode == opcode)
+		  return opcode_table[idx].mnemonic;
+      }
+      return 0;
+}
+
 static int opcode_compare(const void*k, const void*r)
 {
       const char*kp = (const char*)k;
@@ -346,6 +358,8 @@ static symbol_table_t sym_vpi = 0;
  */
 
 
+void resolv_wake(const char*label);
+
 /*
  *  Add a functor to the symbol table
  */
@@ -355,6 +369,7 @@ void define_functor_symbol(const char*label, vvp_net_t*net)
       symbol_value_t val;
       val.net = net;
       sym_set_value(sym_functors, label, val);
+      resolv_wake(label);
 }
 
 static vvp_net_t*lookup_functor_symbol(const char*label)
@@ -443,11 +458,46 @@ vvp_net_t* vvp_net_lookup(const char*label)
  */
 static resolv_list_s*resolv_list = 0;
 
+/*
+ * While linking, a resolve action that fails is parked here, keyed by
+ * the label it is waiting for, instead of being retried on every pass
+ * over the list. When something defines that label, resolv_wake moves
+ * the waiting actions back to the resolv_list to be tried again.
+ */
+static std::map<std::string,resolv_list_s*> resolv_waiting;
+
 resolv_list_s::~resolv_list_s()
 {
       free(label_);
 }
 
+void resolv_park(resolv_list_s*cur)
+{
+      resolv_list_s*&head = resolv_waiting[cur->label()];
+      cur->next = head;
+      head = cur;
+}
+
+void resolv_wake(const char*label)
+{
+      if (resolv_waiting.empty())
+	    return;
+
+      std::map<std::string,resolv_list_s*>::iterator cur
+	    = resolv_waiting.find(label);
+      if (cur == resolv_waiting.end())
+	    return;
+
+      resolv_list_s*res = cur->second;
+      resolv_waiting.erase(cur);
+      while (res) {
+	    resolv_list_s*tmp = res;
+	    res = res->next;
+	    tmp->next = resolv_list;
+	    resolv_list = tmp;
+      }
+}
+
 void resolv_submit(resolv_list_s*cur)
 {
       if (cur->resolve()) {
@@ -726,40 +776,92 @@ void compile_compiletf(struct __vpiSysTaskCall*obj)
 
 void compile_cleanup(void)
 {
-      int lnerrs = -1;
       int nerrs = 0;
-      int last;
+      unsigned long nresolved = 0, nparked = 0;
+      clock_t link_start = clock();
 
       if (verbose_flag) {
 	    fprintf(stderr, " ... Linking\n");
 	    fflush(stderr);
       }
 
-      do {
-	    resolv_list_s *res = resolv_list;
-	    resolv_list = 0x0;
-	    last = nerrs == lnerrs;
-	    lnerrs = nerrs;
-	    nerrs = 0;
+	/* Try each action once. An action that fails waits for its
+	   label to be defined, and is tried again only when that
+	   happens. Resolving one action may define labels that wake
+	   others, so keep going until the resolv_list is empty. */
+      for (;;) {
+	    while (resolv_list) {
+		  resolv_list_s *cur = resolv_list;
+		  resolv_list = cur->next;
+		  if (cur->resolve()) {
+			delete cur;
+			nresolved += 1;
+		  } else {
+			resolv_park(cur);
+			nparked += 1;
+		  }
+	    }
+
+	    if (resolv_waiting.empty())
+		  break;
+
+	      /* Nothing left was woken up. An action may depend on
+		 more than its own label, so give every waiting action
+		 one more try. If none of them make progress, then they
+		 are unresolvable. */
+	    std::map<std::string,resolv_list_s*> sweep;
+	    sweep.swap(resolv_waiting);
+	    unsigned long progress = nresolved;
+	    for (std::map<std::string,resolv_list_s*>::iterator it = sweep.begin()
+		       ; it != sweep.end() ; ++ it) {
+		  resolv_list_s*res = it->second;
+		  while (res) {
+			resolv_list_s*cur = res;
+			res = res->next;
+			if (cur->resolve()) {
+			      delete cur;
+			      nresolved += 1;
+			} else {
+			      resolv_park(cur);
+			}
+		  }
+	    }
+	    if (nresolved == progress)
+		  break;
+      }
+
+	/* Whatever is still waiting is unresolvable. The last chance
+	   resolve prints the error message. */
+      for (std::map<std::string,resolv_list_s*>::iterator it = resolv_waiting.begin()
+		 ; it != resolv_waiting.end() ; ++ it) {
+	    resolv_list_s*res = it->second;
 	    while (res) {
-		  resolv_list_s *cur = res;
+		  resolv_list_s*cur = res;
 		  res = res->next;
-		  if (cur->resolve(last))
+		  if (cur->resolve(true)) {
 			delete cur;
-		  else {
+			nresolved += 1;
+		  } else {
 			nerrs++;
 			cur->next = resolv_list;
 			resolv_list = cur;
 		  }
 	    }
-	    if (nerrs && last)
-		  fprintf(stderr,
-			  "compile_cleanup: %d unresolved items\n",
-			  nerrs);
-      } while (nerrs && !last);
+      }
+      resolv_waiting.clear();
+
+      if (nerrs)
+	    fprintf(stderr, "compile_cleanup: %d unresolved items\n", nerrs);
 
       compile_errors += nerrs;
 
+      if (verbose_flag) {
+	    fprintf(stderr, " ... Linked %lu items (%lu waited) in %.2f seconds\n",
+		    nresolved, nparked,
+		    (double)(clock() - link_start) / CLOCKS_PER_SEC);
+	    fflush(stderr);
+      }
+
       if (verbose_flag) {
 	    fprintf(stderr, " ... Removing symbol tables\n");
 	    fflush(stderr);
@@ -808,6 +910,7 @@ void compile_vpi_symbol(const char*label, vpiHandle obj)
       symbol_value_t val;
       val.ptr = obj;
       sym_set_value(sym_vpi, label, val);
+      resolv_wake(label);
 }
 
 /*
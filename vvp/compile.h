@@ -321,6 +321,8 @@ class resolv_list_s {
 
     private:
       friend void resolv_submit(class resolv_list_s*cur);
+      friend void resolv_park(class resolv_list_s*cur);
+      friend void resolv_wake(const char*label);
       friend void compile_cleanup(void);
 
       char*label_;
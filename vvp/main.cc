@@ -27,9 +27,11 @@
 # include  "statistics.h"
 # include  "vvp_cleanup.h"
 # include  "vvp_object.h"
+# include  "vthread.h"
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
+# include  <string>
 # include  <unistd.h>
 #ifdef CHECK_WITH_VALGRIND
 # include  <pthread.h>
@@ -200,6 +202,9 @@ void set_delay_selection(const char* sel)
 
 static void final_cleanup()
 {
+	/* Finish any output that is still queued for the writer thread. */
+      vpip_mcd_async_stop();
+
       vvp_object::cleanup();
 
 	/*
@@ -213,6 +218,8 @@ static void final_cleanup()
       }
 	/* Clear the static result buffer. */
       (void)need_result_buf(0, RBUF_DEL);
+      activity_delete();
+      profile_delete();
       codespace_delete();
       root_table_delete();
       def_table_delete();
@@ -247,8 +254,94 @@ static void final_cleanup()
 unsigned module_cnt = 0;
 const char*module_tab[64];
 
-extern void vpip_mcd_init(FILE *log);
+extern void vpip_mcd_init(FILE *log, bool async_flag);
 extern void vvp_vpi_init(void);
+extern int vvp_fork_server(const char*path, int&argc, char**&argv);
+extern void vpi_set_vlog_info(int, char**);
+
+/*
+ * The fork server (-S) can serve runs right after the design is
+ * compiled, or from a checkpoint at a simulation time given by -C.
+ * The server loads and (for a checkpoint) runs the design up to that
+ * point once, and each run is a forked copy that continues from
+ * there with its own extended arguments.
+ */
+static const char*serve_path = 0x0;
+static vvp_time64_t serve_time = 0;
+static bool serve_time_flag = false;
+static bool serve_checkpoint_flag = false;
+static bool async_output_flag = false;
+static int run_argc = 0;
+static char**run_argv = 0;
+
+/*
+ * Serve runs. This returns 0 in a forked run, after giving it its own
+ * arguments, and non-zero in the server when it is done.
+ */
+static int serve_runs(void)
+{
+	/* The output thread does not survive the fork, so stop it
+	   here and start it again in each run. */
+      vpip_mcd_async_stop();
+
+      int rc = vvp_fork_server(serve_path, run_argc, run_argv);
+      if (rc != 0)
+	    return rc;
+
+      vpi_set_vlog_info(run_argc, run_argv);
+      if (async_output_flag)
+	    vpip_mcd_async_start();
+
+      return 0;
+}
+
+/*
+ * The -p and -T reports are written at the end of each run. Runs of
+ * the fork server get the path with the run's pid added, so that runs
+ * that are going at the same time do not write the same file.
+ */
+static string report_name(const char*path)
+{
+      string name = path;
+      if (serve_path) {
+	    char buf[32];
+	    snprintf(buf, sizeof buf, ".%ld", (long)getpid());
+	    name += buf;
+      }
+      return name;
+}
+
+static PLI_INT32 serve_checkpoint_cb(p_cb_data)
+{
+      serve_checkpoint_flag = true;
+
+	/* The server's own simulation ends at the checkpoint. The
+	   runs have all been reaped by now. Exit without running the
+	   end of simulation callbacks, which would write and close the
+	   files the design has open as if the server were a run. */
+      int rc = serve_runs();
+      if (rc != 0) {
+	    fflush(0);
+	    _exit(rc < 0? 1 : 0);
+      }
+      return 0;
+}
+
+static PLI_INT32 serve_start_cb(p_cb_data)
+{
+      static struct t_vpi_time cb_time;
+      cb_time.type = vpiSimTime;
+      cb_time.high = (PLI_UINT32) (serve_time >> 32);
+      cb_time.low  = (PLI_UINT32) serve_time;
+
+      struct t_cb_data cb_data;
+      memset(&cb_data, 0, sizeof cb_data);
+      cb_data.reason = cbAtStartOfSimTime;
+      cb_data.cb_rtn = serve_checkpoint_cb;
+      cb_data.time = &cb_time;
+      vpi_register_cb(&cb_data);
+      return 0;
+}
 
 int main(int argc, char*argv[])
 {
@@ -257,8 +350,9 @@ int main(int argc, char*argv[])
       const char*design_path = 0;
       struct rusage cycles[3];
       const char *logfile_name = 0x0;
+      const char *profile_name = 0x0;
+      const char *activity_name = 0x0;
       FILE *logfile = 0x0;
-      extern void vpi_set_vlog_info(int, char**);
       extern bool stop_is_finish;
       extern int  stop_is_finish_exit_code;
 
@@ -315,11 +409,28 @@ int main(int argc, char*argv[])
         /* For non-interactive runs we do not want to run the interactive
          * debugger, so make $stop just execute a $finish. */
       stop_is_finish = false;
-      while ((opt = getopt(argc, argv, "+hil:M:m:nNsvV")) != EOF) switch (opt) {
+      while ((opt = getopt(argc, argv, "+aC:hil:M:m:nNp:sS:T:vV")) != EOF) switch (opt) {
+	  case 'a':
+	    async_output_flag = true;
+	    break;
+	  case 'C': {
+		char*end;
+		serve_time = strtoull(optarg, &end, 10);
+		if (end == optarg || *end != 0) {
+		      fprintf(stderr, "%s: -C expects a simulation time "
+			      "in ticks, not \"%s\".\n", argv[0], optarg);
+		      flag_errors += 1;
+		}
+		serve_time_flag = true;
+		break;
+	  }
          case 'h':
            fprintf(stderr,
                    "Usage: vvp [options] input-file [+plusargs...]\n"
                    "Options:\n"
+                   " -a             Asynchronous (threaded) $display/log output.\n"
+                   " -C ticks       With -S, serve runs from a checkpoint at this\n"
+                   "                simulation time (in precision units).\n"
                    " -h             Print this help message.\n"
                    " -i             Interactive mode (unbuffered stdio).\n"
                    " -l file        Logfile, '-' for <stderr>\n"
@@ -328,7 +439,12 @@ int main(int argc, char*argv[])
                    " -m module      Load vpi module.\n"
 		   " -n             Non-interactive ($stop = $finish).\n"
                    " -N             Same as -n, but exit code is 1 instead of 0\n"
+                   " -p file        Write a thread code profile (folded stacks).\n"
 		   " -s             $stop right away.\n"
+		   " -S path        Load the design, then fork a run for each\n"
+		   "                request on the socket path.\n"
+		   " -T file        Count value changes and write a report of\n"
+		   "                the most active nets and scopes.\n"
                    " -v             Verbose progress messages.\n"
                    " -V             Print the version information.\n" );
            exit(0);
@@ -356,9 +472,20 @@ int main(int argc, char*argv[])
             stop_is_finish = true;
             stop_is_finish_exit_code = 1;
             break;
+	  case 'p':
+	    profile_name = optarg;
+	    vthread_profile_flag = true;
+	    break;
 	  case 's':
 	    schedule_stop(0);
 	    break;
+	  case 'S':
+	    serve_path = optarg;
+	    break;
+	  case 'T':
+	    activity_name = optarg;
+	    vpip_activity_flag = true;
+	    break;
 	  case 'v':
 	    verbose_flag = true;
 	    break;
@@ -369,6 +496,18 @@ int main(int argc, char*argv[])
 	    flag_errors += 1;
       }
 
+      if (serve_time_flag && serve_path == 0) {
+	    fprintf(stderr, "%s: -C is only used with -S.\n", argv[0]);
+	    flag_errors += 1;
+      }
+
+	/* The log file would be opened once and shared by all the
+	   runs, so their lines would be mixed together. */
+      if (logfile_name && serve_path) {
+	    fprintf(stderr, "%s: -l cannot be used with -S.\n", argv[0]);
+	    flag_errors += 1;
+      }
+
       if (flag_errors)
 	    return flag_errors;
 
@@ -425,7 +564,9 @@ int main(int argc, char*argv[])
 	    }
       }
 
-      vpip_mcd_init(logfile);
+      vpip_mcd_init(logfile, async_output_flag);
+
+      stats_phase_start();
 
       if (verbose_flag) {
 	    my_getrusage(cycles+0);
@@ -447,6 +588,8 @@ int main(int argc, char*argv[])
       print_vpi_call_errors();
       if (ret_cd) return ret_cd;
 
+      stats_phase_end(STATS_COMPILE);
+
       if (!have_ivl_version) {
 	    if (verbose_flag) vpi_mcd_printf(1, "... ");
 	    vpi_mcd_printf(1, "Warning: vvp input file may not be correct "
@@ -459,6 +602,8 @@ int main(int argc, char*argv[])
 
       compile_cleanup();
 
+      stats_phase_end(STATS_LINK);
+
       if (compile_errors > 0) {
 	    vpi_mcd_printf(1, "%s: Program not runnable, %u errors.\n",
 		    design_path, compile_errors);
@@ -491,6 +636,26 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, " ... %8lu scopes\n",   count_vpi_scopes);
       }
 
+      run_argc = argc-optind;
+      run_argv = argv+optind;
+      if (serve_path && serve_time == 0) {
+	    int rc = serve_runs();
+	    if (rc != 0) {
+		    /* This is the server, and it is done. */
+		  final_cleanup();
+		  return rc < 0? -1 : 0;
+	    }
+
+      } else if (serve_path) {
+	      /* Serve from the checkpoint time. The time callback can
+		 only be scheduled once the simulation has started. */
+	    struct t_cb_data cb_data;
+	    memset(&cb_data, 0, sizeof cb_data);
+	    cb_data.reason = cbStartOfSimulation;
+	    cb_data.cb_rtn = serve_start_cb;
+	    vpi_register_cb(&cb_data);
+      }
+
       if (verbose_flag) {
 	    my_getrusage(cycles+1);
 	    print_rusage(cycles+1, cycles+0);
@@ -500,6 +665,50 @@ int main(int argc, char*argv[])
 
       schedule_simulate();
 
+	/* If the simulation ended before the -C time, the checkpoint
+	   callback never ran and no runs were served. */
+      if (serve_path && serve_time != 0 && !serve_checkpoint_flag) {
+	    fprintf(stderr, "%s: The simulation finished before the "
+		    "checkpoint time %" TIME_FMT_U " was reached.\n",
+		    argv[0], serve_time);
+	    final_cleanup();
+	    return 1;
+      }
+
+      stats_phase_end(STATS_RUN);
+
+	/* The -stats=<file> extended argument writes the statistics
+	   as JSON. The arguments are checked now because a fork server
+	   run gets its own. */
+      for (int idx = 1 ;  idx < run_argc ;  idx += 1) {
+	    if (strncmp(run_argv[idx], "-stats=", 7) != 0)
+		  continue;
+	    if (! stats_write_json(run_argv[idx]+7))
+		  perror(run_argv[idx]+7);
+      }
+
+      if (profile_name) {
+	    string name = report_name(profile_name);
+	    FILE*profile = fopen(name.c_str(), "w");
+	    if (profile) {
+		  vthread_profile_write(profile);
+		  fclose(profile);
+	    } else {
+		  perror(name.c_str());
+	    }
+      }
+
+      if (activity_name) {
+	    string name = report_name(activity_name);
+	    FILE*activity = fopen(name.c_str(), "w");
+	    if (activity) {
+		  vpip_activity_report(activity, 100);
+		  fclose(activity);
+	    } else {
+		  perror(name.c_str());
+	    }
+      }
+
       if (verbose_flag) {
 	    my_getrusage(cycles+2);
 	    print_rusage(cycles+2, cycles+1);
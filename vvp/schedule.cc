@@ -24,6 +24,7 @@
 # include  "vvp_net_sig.h"
 # include  "slab.h"
 # include  "compile.h"
+# include  "statistics.h"
 # include  <new>
 # include  <typeinfo>
 # include  <csignal>
@@ -40,6 +41,16 @@ unsigned long count_gen_events = 0;
 unsigned long count_thread_events = 0;
   // Count the time events (A time cell created)
 unsigned long count_time_events = 0;
+  // Count the events scheduled into each region of a time step.
+unsigned long count_start_events = 0;
+unsigned long count_active_events = 0;
+unsigned long count_nbassign_events = 0;
+unsigned long count_rwsync_events = 0;
+unsigned long count_rosync_events = 0;
+unsigned long count_del_thr_events = 0;
+  // The most time steps that were pending at once.
+unsigned long count_time_queue_peak = 0;
+static unsigned long time_queue_depth = 0;
 
 
 
@@ -539,11 +550,15 @@ inline void* event_time_s::operator new (size_t size)
 {
       assert(size == sizeof(struct event_time_s));
       void*ptr = event_time_heap.alloc_slab();
+      time_queue_depth += 1;
+      if (time_queue_depth > count_time_queue_peak)
+	    count_time_queue_peak = time_queue_depth;
       return ptr;
 }
 
 inline void event_time_s::operator delete(void*ptr, size_t)
 {
+      time_queue_depth -= 1;
       event_time_heap.free_slab(ptr);
 }
 
@@ -730,26 +745,32 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
       switch (select_queue) {
 	  case SEQ_START:
 	    q = &ctim->start;
+	    count_start_events += 1;
 	    break;
 
 	  case SEQ_ACTIVE:
 	    q = &ctim->active;
+	    count_active_events += 1;
 	    break;
 
 	  case SEQ_NBASSIGN:
 	    q = &ctim->nbassign;
+	    count_nbassign_events += 1;
 	    break;
 
 	  case SEQ_RWSYNC:
 	    q = &ctim->rwsync;
+	    count_rwsync_events += 1;
 	    break;
 
 	  case SEQ_ROSYNC:
 	    q = &ctim->rosync;
+	    count_rosync_events += 1;
 	    break;
 
 	  case DEL_THREAD:
 	    q = &ctim->del_thr;
+	    count_del_thr_events += 1;
 	    break;
       }
 
@@ -770,6 +791,8 @@ static void schedule_event_push_(struct event_s*cur)
 	    return;
       }
 
+      count_active_events += 1;
+
       struct event_time_s*ctim = sched_list;
 
       if (ctim->active == 0) {
@@ -1091,6 +1114,8 @@ void schedule_simulate(void)
 
       signals_capture();
 
+      stats_phase_end(STATS_INIT);
+
       if (verbose_flag) {
 	    vpi_mcd_printf(1, " ...run scheduler\n");
       }
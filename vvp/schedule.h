@@ -201,4 +201,12 @@ extern unsigned long count_prop_events;
 extern unsigned long count_thread_events;
 extern unsigned long count_event_pool;
 
+extern unsigned long count_start_events;
+extern unsigned long count_active_events;
+extern unsigned long count_nbassign_events;
+extern unsigned long count_rwsync_events;
+extern unsigned long count_rosync_events;
+extern unsigned long count_del_thr_events;
+extern unsigned long count_time_queue_peak;
+
 #endif /* IVL_schedule_H */
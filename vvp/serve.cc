@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This is the fork server (vvp -S <path>). The design is loaded,
+ * linked and compiletf'ed once, then the server listens on a unix
+ * domain socket. Each connection sends a single line of extra
+ * arguments (typically +args) for a run. The server forks a child
+ * for the run, and the child returns to main with those arguments
+ * appended to the vlog_info argument list, and with its stdout and
+ * stderr going back over the connection. The children share the
+ * already loaded design copy-on-write.
+ *
+ * A connection that sends the line "quit" stops the server. The
+ * server then waits for any runs still going before it returns.
+ */
+
+# include  "config.h"
+# include  "compile.h"
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <cctype>
+# include  <cerrno>
+# include  <string>
+# include  <vector>
+#ifndef __MINGW32__
+# include  <unistd.h>
+# include  <sys/types.h>
+# include  <sys/socket.h>
+# include  <sys/un.h>
+# include  <sys/stat.h>
+# include  <sys/wait.h>
+#endif
+
+using namespace std;
+
+#ifndef __MINGW32__
+
+static void reap_children(bool wait_flag)
+{
+      for (;;) {
+	    int status;
+	    pid_t pid = waitpid(-1, &status, wait_flag? 0 : WNOHANG);
+	    if (pid > 0)
+		  continue;
+	    if (pid < 0 && errno == EINTR)
+		  continue;
+	    break;
+      }
+}
+
+/*
+ * Read the request line, up to the newline or the end of the
+ * stream, from the connection.
+ */
+static bool read_request(int fd, string&line)
+{
+      const size_t max_request = 64*1024;
+      char ch;
+
+      line.clear();
+      for (;;) {
+	    ssize_t rc = read(fd, &ch, 1);
+	    if (rc < 0 && errno == EINTR)
+		  continue;
+	    if (rc < 0)
+		  return false;
+	    if (rc == 0 || ch == '\n')
+		  return true;
+	    if (line.size() >= max_request)
+		  return false;
+	    line += ch;
+      }
+}
+
+/*
+ * Build the argument list for a run. It is the server's own vlog_info
+ * arguments followed by the white space separated words of the
+ * request. The strings are never freed; the child uses them until
+ * it exits.
+ */
+static void make_run_args(const string&line, int&argc, char**&argv)
+{
+      vector<char*> args (argv, argv+argc);
+
+      size_t pos = 0;
+      for (;;) {
+	    while (pos < line.size() && isspace((unsigned char)line[pos]))
+		  pos += 1;
+	    if (pos == line.size())
+		  break;
+
+	    size_t end = pos;
+	    while (end < line.size() && !isspace((unsigned char)line[end]))
+		  end += 1;
+
+	    args.push_back(strdup(line.substr(pos, end-pos).c_str()));
+	    pos = end;
+      }
+
+      argc = args.size();
+      argv = new char*[argc+1];
+      for (int idx = 0 ;  idx < argc ;  idx += 1)
+	    argv[idx] = args[idx];
+      argv[argc] = 0;
+}
+
+int vvp_fork_server(const char*path, int&argc, char**&argv)
+{
+      struct sockaddr_un addr;
+      if (strlen(path) >= sizeof addr.sun_path) {
+	    fprintf(stderr, "%s: Server socket path is too long.\n", path);
+	    return -1;
+      }
+
+	/* A socket left by an earlier server is removed, but never
+	   anything else that is in the way. */
+      struct stat sb;
+      if (lstat(path, &sb) == 0) {
+	    if (! S_ISSOCK(sb.st_mode)) {
+		  fprintf(stderr, "%s: Exists and is not a socket.\n", path);
+		  return -1;
+	    }
+	    unlink(path);
+      }
+
+      int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (sock < 0) {
+	    perror("socket");
+	    return -1;
+      }
+
+      memset(&addr, 0, sizeof addr);
+      addr.sun_family = AF_UNIX;
+      strcpy(addr.sun_path, path);
+
+	/* Anyone who can connect can start a run as this user, so
+	   the socket is only made accessible to the owner. */
+      mode_t save_mask = umask(077);
+      int rc = bind(sock, (struct sockaddr*)&addr, sizeof addr);
+      umask(save_mask);
+      if (rc < 0) {
+	    perror(path);
+	    close(sock);
+	    return -1;
+      }
+      if (chmod(path, 0600) < 0) {
+	    perror(path);
+	    close(sock);
+	    unlink(path);
+	    return -1;
+      }
+
+      if (listen(sock, 16) < 0) {
+	    perror(path);
+	    close(sock);
+	    unlink(path);
+	    return -1;
+      }
+
+      if (verbose_flag)
+	    fprintf(stderr, " ... Waiting for runs on %s\n", path);
+
+      for (;;) {
+	    reap_children(false);
+
+	    int conn = accept(sock, 0, 0);
+	    if (conn < 0) {
+		  if (errno == EINTR)
+			continue;
+		  perror("accept");
+		  break;
+	    }
+
+	    string line;
+	    if (! read_request(conn, line)) {
+		  close(conn);
+		  continue;
+	    }
+
+	    if (line == "quit") {
+		  close(conn);
+		  break;
+	    }
+
+	      /* Anything still buffered in the server would otherwise
+		 be written again by the child. */
+	    fflush(0);
+
+	    pid_t pid = fork();
+	    if (pid < 0) {
+		  perror("fork");
+		  close(conn);
+		  continue;
+	    }
+
+	    if (pid == 0) {
+		  close(sock);
+		  dup2(conn, 1);
+		  dup2(conn, 2);
+		  close(conn);
+		  make_run_args(line, argc, argv);
+		  return 0;
+	    }
+
+	    close(conn);
+      }
+
+      close(sock);
+      unlink(path);
+      reap_children(true);
+      return 1;
+}
+
+#else
+
+int vvp_fork_server(const char*path, int&, char**&)
+{
+      fprintf(stderr, "%s: The fork server is not supported "
+	      "on this platform.\n", path);
+      return -1;
+}
+
+#endif
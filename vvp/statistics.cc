@@ -17,7 +17,19 @@
  *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+# include  "config.h"
+# include  "version_base.h"
 # include  "statistics.h"
+# include  "schedule.h"
+# include  "vvp_net.h"
+# include  "vpi_priv.h"
+# include  <cstdio>
+# include  <cstring>
+# include  <ctime>
+#if defined(HAVE_SYS_RESOURCE_H)
+# include  <sys/time.h>
+# include  <sys/resource.h>
+#endif
 
 /*
  * This is a count of the instruction opcodes that were created.
@@ -37,3 +49,176 @@ unsigned long count_vpi_scopes = 0;
 
 size_t size_opcodes = 0;
 
+/*
+ * The phase table. Each finished phase has the wall and CPU seconds
+ * it took and the peak resident size when it finished. A phase that
+ * is still running is reported up to the time of the report.
+ */
+struct stats_snap_s {
+      double wall;
+      double cpu;
+      long max_rss_kb;
+};
+
+struct stats_phase_s {
+      bool done;
+      double wall;
+      double cpu;
+      long max_rss_kb;
+};
+
+static const char*phase_names[STATS_PHASES] = {
+      "compile", "link", "init", "run"
+};
+
+static stats_phase_s phase_tab[STATS_PHASES];
+static stats_snap_s phase_mark;
+static unsigned phase_cur = STATS_PHASES;
+
+static void take_snap(stats_snap_s&snap)
+{
+#if defined(HAVE_SYS_RESOURCE_H)
+      struct timeval tv;
+      gettimeofday(&tv, 0);
+      snap.wall = tv.tv_sec + tv.tv_usec/1E6;
+
+      struct rusage ru;
+      getrusage(RUSAGE_SELF, &ru);
+      snap.cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec/1E6
+	    +    ru.ru_stime.tv_sec + ru.ru_stime.tv_usec/1E6;
+#if defined(__APPLE__)
+	/* macOS reports the peak resident size in bytes. */
+      snap.max_rss_kb = ru.ru_maxrss / 1024;
+#else
+      snap.max_rss_kb = ru.ru_maxrss;
+#endif
+#else
+      snap.wall = (double)time(0);
+      snap.cpu = (double)clock() / CLOCKS_PER_SEC;
+      snap.max_rss_kb = 0;
+#endif
+}
+
+void stats_phase_start(void)
+{
+      take_snap(phase_mark);
+      phase_cur = STATS_COMPILE;
+}
+
+void stats_phase_end(stats_phase_t phase)
+{
+      stats_snap_s now;
+      take_snap(now);
+
+      phase_tab[phase].done = true;
+      phase_tab[phase].wall = now.wall - phase_mark.wall;
+      phase_tab[phase].cpu  = now.cpu  - phase_mark.cpu;
+      phase_tab[phase].max_rss_kb = now.max_rss_kb;
+
+      phase_mark = now;
+      phase_cur = phase + 1;
+}
+
+static void write_phases(FILE*fd)
+{
+      stats_snap_s now;
+      take_snap(now);
+
+      fprintf(fd, "  \"phases\": {");
+      const char*sep = "\n";
+      for (unsigned idx = 0 ; idx < STATS_PHASES ; idx += 1) {
+	    stats_phase_s cur = phase_tab[idx];
+	    if (! cur.done) {
+		  if (idx != phase_cur)
+			continue;
+		  cur.wall = now.wall - phase_mark.wall;
+		  cur.cpu  = now.cpu  - phase_mark.cpu;
+		  cur.max_rss_kb = now.max_rss_kb;
+	    }
+
+	    fprintf(fd, "%s    \"%s\": {\"wall_s\": %.6f, \"cpu_s\": %.6f, "
+		    "\"max_rss_kb\": %ld, \"done\": %s}", sep,
+		    phase_names[idx], cur.wall, cur.cpu, cur.max_rss_kb,
+		    cur.done? "true" : "false");
+	    sep = ",\n";
+      }
+      fprintf(fd, "\n  },\n");
+}
+
+bool stats_write_json(const char*path)
+{
+      FILE*fd = strcmp(path, "-") == 0? stdout : fopen(path, "w");
+      if (fd == 0)
+	    return false;
+
+	/* Text that $display has queued for <stdout> must come first. */
+      if (fd == stdout)
+	    vpip_mcd_sync();
+
+      fprintf(fd, "{\n");
+      fprintf(fd, "  \"version\": \"%s\",\n", VERSION);
+      fprintf(fd, "  \"sim_time\": %" TIME_FMT_U ",\n", schedule_simtime());
+
+      write_phases(fd);
+
+      fprintf(fd, "  \"design\": {\n");
+      fprintf(fd, "    \"functors\": %lu,\n", count_functors);
+      fprintf(fd, "    \"functors_logic\": %lu,\n", count_functors_logic);
+      fprintf(fd, "    \"functors_bufif\": %lu,\n", count_functors_bufif);
+      fprintf(fd, "    \"functors_resolv\": %lu,\n", count_functors_resolv);
+      fprintf(fd, "    \"functors_sig\": %lu,\n", count_functors_sig);
+      fprintf(fd, "    \"filters\": %lu,\n", count_filters);
+      fprintf(fd, "    \"opcodes\": %lu,\n", count_opcodes);
+      fprintf(fd, "    \"opcode_bytes\": %zu,\n", size_opcodes);
+      fprintf(fd, "    \"vpi_nets\": %lu,\n", count_vpi_nets);
+      fprintf(fd, "    \"vvp_nets\": %lu,\n", count_vvp_nets);
+      fprintf(fd, "    \"vvp_net_bytes\": %zu,\n", size_vvp_nets);
+      fprintf(fd, "    \"net_arrays\": %lu,\n", count_net_arrays);
+      fprintf(fd, "    \"net_array_words\": %lu,\n", count_net_array_words);
+      fprintf(fd, "    \"var_arrays\": %lu,\n", count_var_arrays);
+      fprintf(fd, "    \"var_array_words\": %lu,\n", count_var_array_words);
+      fprintf(fd, "    \"real_arrays\": %lu,\n", count_real_arrays);
+      fprintf(fd, "    \"real_array_words\": %lu,\n", count_real_array_words);
+      fprintf(fd, "    \"scopes\": %lu\n", count_vpi_scopes);
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"events\": {\n");
+      fprintf(fd, "    \"time_steps\": %lu,\n", count_time_events);
+      fprintf(fd, "    \"time_queue_peak\": %lu,\n", count_time_queue_peak);
+      fprintf(fd, "    \"thread\": %lu,\n", count_thread_events);
+      fprintf(fd, "    \"assign\": %lu,\n", count_assign_events);
+      fprintf(fd, "    \"other\": %lu,\n", count_gen_events);
+      fprintf(fd, "    \"regions\": {\"start\": %lu, \"active\": %lu, "
+	      "\"nbassign\": %lu, \"rwsync\": %lu, \"rosync\": %lu, "
+	      "\"del_thread\": %lu}\n",
+	      count_start_events, count_active_events, count_nbassign_events,
+	      count_rwsync_events, count_rosync_events, count_del_thr_events);
+      fprintf(fd, "  },\n");
+
+	/* The slab pools never shrink, so their sizes are the high
+	   water marks of the items in use. */
+      fprintf(fd, "  \"pools\": {\n");
+      fprintf(fd, "    \"net_fun_bytes\": %zu,\n", vvp_net_fun_t::heap_total());
+      fprintf(fd, "    \"net_fil_bytes\": %zu,\n", vvp_net_fil_t::heap_total());
+      fprintf(fd, "    \"time\": %lu,\n", count_time_pool());
+      fprintf(fd, "    \"assign_vec4\": %lu,\n", count_assign4_pool());
+      fprintf(fd, "    \"assign_vec8\": %lu,\n", count_assign8_pool());
+      fprintf(fd, "    \"assign_real\": %lu,\n", count_assign_real_pool());
+      fprintf(fd, "    \"assign_word\": %lu,\n", count_assign_aword_pool());
+      fprintf(fd, "    \"assign_word_real\": %lu,\n", count_assign_arword_pool());
+      fprintf(fd, "    \"other\": %lu\n", count_gen_pool());
+      fprintf(fd, "  }\n");
+      fprintf(fd, "}\n");
+
+      if (fd == stdout) {
+	    fflush(fd);
+	    return true;
+      }
+      return fclose(fd) == 0;
+}
+
+PLI_INT32 vpip_write_stats(const char*path)
+{
+      return stats_write_json(path)? 1 : 0;
+}
+
@@ -62,4 +62,22 @@ extern size_t size_opcodes;
 extern size_t size_vvp_nets;
 extern size_t size_vvp_net_funs;
 
+/*
+ * The wall and CPU time and the peak resident size are also taken for
+ * each phase of the run. stats_phase_start starts the compile phase,
+ * and stats_phase_end ends the given phase and starts the next one.
+ */
+enum stats_phase_t { STATS_COMPILE = 0, STATS_LINK, STATS_INIT, STATS_RUN,
+		     STATS_PHASES };
+
+extern void stats_phase_start(void);
+extern void stats_phase_end(stats_phase_t phase);
+
+/*
+ * Write all the statistics as a JSON object to the path. The path
+ * "-" is the standard output. Return false if the file cannot be
+ * written.
+ */
+extern bool stats_write_json(const char*path);
+
 #endif /* IVL_statistics_H */
@@ -268,7 +268,7 @@ static void cmd_list(unsigned, char*[])
 
 		case vpiReg:
 		  sig = dynamic_cast<__vpiSignal*>(table[idx]);
-		  if ((sig->msb.get_value() == 0) && (sig->lsb.get_value() == 0))
+		  if ((sig->msb == 0) && (sig->lsb == 0))
 			printf("reg     : %s%s\n",
 			       vpi_get_str(vpiName, table[idx]),
 			       sig->signed_flag? "signed " : "");
@@ -276,12 +276,12 @@ static void cmd_list(unsigned, char*[])
 			printf("reg     : %s%s[%d:%d]\n",
 			       vpi_get_str(vpiName, table[idx]),
 			       sig->signed_flag? "signed " : "",
-			       sig->msb.get_value(), sig->lsb.get_value());
+			       sig->msb, sig->lsb);
 		  break;
 
 		case vpiNet:
 		  sig = dynamic_cast<__vpiSignal*>(table[idx]);
-		  if ((sig->msb.get_value() == 0) && (sig->lsb.get_value() == 0))
+		  if ((sig->msb == 0) && (sig->lsb == 0))
 			printf("net     : %s%s\n",
 			       vpi_get_str(vpiName, table[idx]),
 			       sig->signed_flag? "signed " : "");
@@ -289,7 +289,7 @@ static void cmd_list(unsigned, char*[])
 			printf("net     : %s%s[%d:%d]\n",
 			       vpi_get_str(vpiName, table[idx]),
 			       sig->signed_flag? "signed " : "",
-			       sig->msb.get_value(), sig->lsb.get_value());
+			       sig->msb, sig->lsb);
 		  break;
 
 		default:
@@ -545,6 +545,8 @@ void stop_handler(int rc)
       invoke_command_const("$dumpflush");
       vpi_mcd_printf(1,"** Current simulation time is %" TIME_FMT_U " ticks.\n",
 		     schedule_simtime());
+	/* The interactive commands write directly to <stdout>. */
+      vpip_mcd_sync();
 
       interact_flag = true;
       while (interact_flag) {
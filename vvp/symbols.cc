@@ -55,341 +55,117 @@ char*symbol_table_s::key_strdup_(const char*str)
 }
 
 /*
- * This is a B-Tree data structure, where there are nodes and
- * leaves.
- *
- * Nodes have a bunch of pointers to children. Each child pointer has
- * associated with it a key that is the largest key referenced by that
- * child. So, if the key being searched for has a value <= the first
- * key of a node, then the value is in the first child.
- *
- * leaves have a sorted table of key-value pairs. The search can use a
- * simple binary search to find an item. Each key represents an item.
+ * The table itself is an open addressed hash table, with linear
+ * probing, of key/value slots. The table size is always a power of 2,
+ * and it is doubled whenever it becomes 3/4 full. The full hash of
+ * the key is kept in the slot so that the probe only compares
+ * strings when the hashes match, and so that growing the table
+ * doesn't need to hash the keys again. Keys are never removed, so
+ * there are no tombstones to deal with.
  */
 
-const unsigned leaf_width = 254;
-const unsigned node_width = 508;
+const unsigned long initial_table_size = 1024;
 
-struct tree_data_ {
+struct table_slot_ {
       char*key;
+      unsigned long hash;
       symbol_value_t val;
 };
 
-struct tree_node_ {
-      bool leaf_flag;
-      unsigned count;
-      struct tree_node_*parent;
-
-      union {
-	    struct tree_data_ leaf[leaf_width];
-	    struct tree_node_ *child[node_width];
-      };
-
-};
-
-static inline char* node_last_key(struct tree_node_*node)
+static inline unsigned long hash_key(const char*key)
 {
-      while (node->leaf_flag == false)
-	    node = node->child[node->count-1];
-
-      return node->leaf[node->count-1].key;
+	/* This is the FNV-1a string hash. */
+      unsigned long h = 2166136261UL;
+      for ( ; *key ;  key += 1) {
+	    h ^= (unsigned char)*key;
+	    h *= 16777619UL;
+      }
+      return h;
 }
 
 /*
- * Allocate a new symbol table means creating the table structure and
- * a root node, and initializing the pointers and members of the root
- * node.
+ * Allocate a new symbol table means creating the (empty) slot table
+ * and the first chunk of key strings.
  */
 symbol_table_s::symbol_table_s()
 {
-      root = new struct tree_node_;
-      root->leaf_flag = false;
-      root->count = 0;
-      root->parent = 0;
+      table_mask_ = initial_table_size - 1;
+      table_count_ = 0;
+      table_ = new struct table_slot_[initial_table_size];
+      for (unsigned long idx = 0 ;  idx <= table_mask_ ;  idx += 1)
+	    table_[idx].key = 0;
 
       str_chunk = new key_strings;
       str_chunk->next = 0;
       str_used = 0;
 }
 
-static void delete_symbol_node(struct tree_node_*cur)
-{
-      if (! cur->leaf_flag) {
-	    for (unsigned idx = 0 ;  idx < cur->count ;  idx += 1)
-		  delete_symbol_node(cur->child[idx]);
-      }
-
-      delete cur;
-}
-
-/* Do as split_leaf_ does, but for nodes. */
-static void split_node_(struct tree_node_*cur)
-{
-      assert(!cur->leaf_flag);
-      if (cur->parent) assert(! cur->parent->leaf_flag);
-
-      while (cur->count == node_width) {
-	      /* Create a new node to hold half the data from cur. */
-	    struct tree_node_ *new_node = new struct tree_node_;
-	    new_node->leaf_flag = false;
-	    new_node->count = cur->count / 2;
-	      /* cur is not root; new_node becomes sibling. */
-	    if (cur->parent) new_node->parent = cur->parent;
-
-	      /* Move the last half of the data from the end of the old node
-	       * to the beginning of the new node. At the same time, reduce
-	       * the size of the old node. */
-	    unsigned idx1 = new_node->count;
-	    unsigned idx2 = cur->count;
-	    while (idx1 > 0) {
-		  idx1 -= 1;
-		  idx2 -= 1;
-		  new_node->child[idx1] = cur->child[idx2];
-		  new_node->child[idx1]->parent = new_node;
-		  cur->count -= 1;
-	    }
-
-	    assert(new_node->count > 0);
-	    assert(cur->count > 0);
-
-	    if (cur->parent == 0) {
-		    /* cur is root. Move first half of children to another
-		     * new node, and put the two new nodes in cur. The plan
-		     * here is to make cur into the new root and split its
-		     * contents into 2 children. */
-
-		  new_node->parent = cur;
-		  struct tree_node_*new2_node = new struct tree_node_;
-		  new2_node->leaf_flag = false;
-		  new2_node->count = cur->count;
-		  new2_node->parent = cur;
-		  for (unsigned idx = 0; idx < cur->count; idx += 1) {
-			new2_node->child[idx] = cur->child[idx];
-			new2_node->child[idx]->parent = new2_node;
-		  }
-		  cur->child[0] = new2_node;
-		  cur->child[1] = new_node;
-		  cur->count = 2;
-		    /* no more ancestors, stop the while loop */
-		  break;
-	    }
-
-	      /* cur is not root. hook new_node to cur->parent. */
-	    unsigned idx = 0;
-	    while (cur->parent->child[idx] != cur) {
-		  assert(idx < cur->parent->count);
-		  idx += 1;
-	    }
-	    idx += 1;
-
-	    for (unsigned tmp = cur->parent->count ;  tmp > idx ;  tmp -= 1) {
-		  cur->parent->child[tmp] = cur->parent->child[tmp-1];
-	    }
-
-	    cur->parent->child[idx] = new_node;
-	    cur->parent->count += 1;
-
-	      /* check the ancestor */
-	    cur = cur->parent;
-      }
-}
-
-/*
- * This function takes a leaf node and splits in into two. Move half
- * the leaf keys into the new node, and add the new leaf into the
- * parent node.
- */
-static struct tree_node_* split_leaf_(struct tree_node_*cur)
+void symbol_table_s::grow_table_(void)
 {
-      assert(cur->leaf_flag);
-      assert(cur->parent);
-      assert(! cur->parent->leaf_flag);
+      struct table_slot_*old_table = table_;
+      unsigned long old_size = table_mask_ + 1;
 
-	/* Create a new leaf to hold half the data from the old leaf. */
-      struct tree_node_*new_leaf = new struct tree_node_;
-      new_leaf->leaf_flag = true;
-      new_leaf->count = cur->count / 2;
-      new_leaf->parent = cur->parent;
+      table_mask_ = 2*old_size - 1;
+      table_ = new struct table_slot_[2*old_size];
+      for (unsigned long idx = 0 ;  idx <= table_mask_ ;  idx += 1)
+	    table_[idx].key = 0;
 
-	/* Move the last half of the data from the end of the old leaf
-	   to the beginning of the new leaf. At the same time, reduce
-	   the size of the old leaf. */
-      unsigned idx1 = new_leaf->count;
-      unsigned idx2 = cur->count;
-      while (idx1 > 0) {
-	    idx1 -= 1;
-	    idx2 -= 1;
-	    new_leaf->leaf[idx1] = cur->leaf[idx2];
-	    cur->count -= 1;
-      }
+      for (unsigned long idx = 0 ;  idx < old_size ;  idx += 1) {
+	    if (old_table[idx].key == 0)
+		  continue;
 
-      assert(new_leaf->count > 0);
-      assert(cur->count > 0);
+	    unsigned long pos = old_table[idx].hash & table_mask_;
+	    while (table_[pos].key)
+		  pos = (pos + 1) & table_mask_;
 
-      unsigned idx = 0;
-      while (cur->parent->child[idx] != cur) {
-	    assert(idx < cur->parent->count);
-	    idx += 1;
+	    table_[pos] = old_table[idx];
       }
 
-      idx += 1;
-
-      for (unsigned tmp = cur->parent->count ;  tmp > idx ;  tmp -= 1)
-	    cur->parent->child[tmp] = cur->parent->child[tmp-1];
-
-      cur->parent->child[idx] = new_leaf;
-      cur->parent->count += 1;
-
-      if (cur->parent->count == node_width)
-	    split_node_(cur->parent);
-
-      return new_leaf;
+      delete[]old_table;
 }
 
-
 /*
- * This function searches tree recursively for the key. If the value
- * is not found (and we are at a leaf) then set the key with the given
- * value. If the key is found, set the value only if the force_flag is
- * true.
+ * Locate the slot for the key. If the key is not in the table yet,
+ * then add it with a zero value.
  */
-
-symbol_value_t symbol_table_s::find_value_(struct tree_node_*cur,
-					   const char*key, symbol_value_t val,
-					   bool force_flag)
+struct table_slot_* symbol_table_s::find_slot_(const char*key)
 {
-      if (cur->leaf_flag) {
-
-	    unsigned idx = 0;
-	    for (;;) {
-		    /* If we run out of keys in the leaf, then add
-		       this at the end of the leaf. */
-		  if (idx == cur->count) {
-			cur->leaf[idx].key = key_strdup_(key);
-			cur->leaf[idx].val = val;
-			cur->count += 1;
-			if (cur->count == leaf_width)
-			      split_leaf_(cur);
-
-			return val;
-		  }
-
-		  int rc = strcmp(key, cur->leaf[idx].key);
-
-		    /* If we found the key already in the table, then
-		       set the new value and break. */
-		  if (rc == 0) {
-			if (force_flag)
-			      cur->leaf[idx].val = val;
-			return cur->leaf[idx].val;
-		  }
+      unsigned long hash = hash_key(key);
+      unsigned long pos = hash & table_mask_;
 
-		    /* If this key goes before the current key, then
-		       push all the following entries back and add
-		       this key here. */
-		  if (rc < 0) {
-			for (unsigned tmp = cur->count; tmp > idx; tmp -= 1)
-			      cur->leaf[tmp] = cur->leaf[tmp-1];
-
-			cur->leaf[idx].key = key_strdup_(key);
-			cur->leaf[idx].val = val;
-			cur->count += 1;
-			if (cur->count == leaf_width)
-			      split_leaf_(cur);
-
-			return val;
-		  }
-
-		  idx += 1;
-	    }
-
-      } else {
-	      /* Do a binary search within the inner node. */
-	    unsigned min = 0;
-	    unsigned max = cur->count;
-	    unsigned idx = max/2;
-	    for (;;) {
-		  int rc = strcmp(key, node_last_key(cur->child[idx]));
-		  if (rc == 0) {
-			return find_value_(cur->child[idx],
-					   key, val, force_flag);
-		  }
-
-		  if (rc > 0) {
-			min = idx + 1;
-			if (min == cur->count)
-			      return find_value_(cur->child[idx],
-						 key, val, force_flag);
-			if (min == max)
-			      return find_value_(cur->child[max],
-						 key, val, force_flag);
-
-			idx = min + (max-min)/2;
-
-		  } else  {
-			max = idx;
-			if (idx == min)
-			      return find_value_(cur->child[idx],
-						 key, val, force_flag);
-			idx = min + (max-min)/2;
-		  }
-	    }
+      while (table_[pos].key) {
+	    if (table_[pos].hash == hash && strcmp(table_[pos].key, key) == 0)
+		  return table_ + pos;
+	    pos = (pos + 1) & table_mask_;
       }
 
-      assert(0);
-      { symbol_value_t tmp;
-        tmp.num = 0;
-        return tmp;
+      if (4*(table_count_+1) > 3*(table_mask_+1)) {
+	    grow_table_();
+	    pos = hash & table_mask_;
+	    while (table_[pos].key)
+		  pos = (pos + 1) & table_mask_;
       }
+
+      table_count_ += 1;
+      table_[pos].key = key_strdup_(key);
+      table_[pos].hash = hash;
+      table_[pos].val.num = 0;
+      return table_ + pos;
 }
 
 void symbol_table_s::sym_set_value(const char*key, symbol_value_t val)
 {
-      if (root->count == 0) {
-	      /* Handle the special case that this is the very first
-		 value in the symbol table. Create the first leaf node
-		 and initialize the pointers. */
-	    struct tree_node_*cur = new struct tree_node_;
-	    cur->leaf_flag = true;
-	    cur->parent = root;
-	    cur->count = 1;
-	    cur->leaf[0].key = key_strdup_(key);
-	    cur->leaf[0].val = val;
-
-	    root->count = 1;
-	    root->child[0] = cur;
-      } else {
-	    find_value_(root, key, val, true);
-      }
+      find_slot_(key)->val = val;
 }
 
 symbol_value_t symbol_table_s::sym_get_value(const char*key)
 {
-      symbol_value_t def;
-      def.num = 0;
-
-      if (root->count == 0) {
-	      /* Handle the special case that this is the very first
-		 value in the symbol table. Create the first leaf node
-		 and initialize the pointers. */
-	    struct tree_node_*cur = new struct tree_node_;
-	    cur->leaf_flag = true;
-	    cur->parent = root;
-	    cur->count = 1;
-	    cur->leaf[0].key = key_strdup_(key);
-	    cur->leaf[0].val = def;
-
-	    root->count = 1;
-	    root->child[0] = cur;
-	    return cur->leaf[0].val;
-      } else {
-	    return find_value_(root, key, def, false);
-      }
+      return find_slot_(key)->val;
 }
 
 symbol_table_s::~symbol_table_s()
 {
-      delete_symbol_node(root);
+      delete[]table_;
       while (str_chunk) {
 	    key_strings*tmp = str_chunk;
 	    str_chunk = tmp->next;
@@ -37,6 +37,11 @@
 # include  <cstdio>
 # include  <cassert>
 # include  <cstdlib>
+# include  <stdint.h>
+# include  <algorithm>
+# include  <map>
+# include  <string>
+# include  <vector>
 /*
  * Callback handles are created when the VPI function registers a
  * callback. The handle is stored by the run time, and it triggered
@@ -692,6 +697,199 @@ void vvp_vpi_callback::clear_all_callbacks()
 }
 #endif
 
+/*
+ * When activity counting is enabled (vvp -T) every update that
+ * reaches run_vpi_callbacks is counted for the signal filter that saw
+ * it. An update is a value that passed through the filter. For vec4
+ * nets that is always a change, but strength (vec8) nets and real
+ * variables also pass on values that are the same as before.
+ *
+ * The counts are kept in a hash table keyed by the filter, which is
+ * only allocated once something is counted, so that the filters do
+ * not carry a count when -T is not used. The table is open addressed
+ * and grows when it is half full.
+ */
+bool vpip_activity_flag = false;
+
+struct activity_slot_s {
+      const vvp_vpi_callback*key;
+      unsigned long count;
+};
+
+static activity_slot_s*activity_tab = 0;
+static size_t activity_mask = 0;
+static size_t activity_used = 0;
+
+static size_t activity_hash(const vvp_vpi_callback*key)
+{
+      size_t hash = (size_t)((uintptr_t)key >> 3);
+      return hash * 2654435761U;
+}
+
+static void activity_grow(void)
+{
+      activity_slot_s*old_tab = activity_tab;
+      size_t old_size = old_tab? activity_mask + 1 : 0;
+      size_t new_size = old_size? 2*old_size : 1024;
+
+      activity_tab = new activity_slot_s[new_size];
+      for (size_t idx = 0 ; idx < new_size ; idx += 1) {
+	    activity_tab[idx].key = 0;
+	    activity_tab[idx].count = 0;
+      }
+      activity_mask = new_size - 1;
+
+      for (size_t idx = 0 ; idx < old_size ; idx += 1) {
+	    if (old_tab[idx].key == 0)
+		  continue;
+	    size_t pos = activity_hash(old_tab[idx].key) & activity_mask;
+	    while (activity_tab[pos].key)
+		  pos = (pos + 1) & activity_mask;
+	    activity_tab[pos] = old_tab[idx];
+      }
+      delete[] old_tab;
+}
+
+/*
+ * Return the count of the filter, adding it to the table if needed.
+ */
+static unsigned long& activity_slot(const vvp_vpi_callback*key)
+{
+      if (2*(activity_used+1) > (activity_tab? activity_mask+1 : 0))
+	    activity_grow();
+
+      size_t pos = activity_hash(key) & activity_mask;
+      while (activity_tab[pos].key && activity_tab[pos].key != key)
+	    pos = (pos + 1) & activity_mask;
+
+      if (activity_tab[pos].key == 0) {
+	    activity_tab[pos].key = key;
+	    activity_used += 1;
+      }
+      return activity_tab[pos].count;
+}
+
+#ifdef CHECK_WITH_VALGRIND
+void activity_delete(void)
+{
+      delete[] activity_tab;
+      activity_tab = 0;
+      activity_mask = 0;
+      activity_used = 0;
+}
+#endif
+
+static unsigned long activity_count_of(const vvp_net_t*net)
+{
+      if (net == 0 || net->fil == 0 || activity_tab == 0)
+	    return 0;
+
+      const vvp_vpi_callback*key = net->fil;
+      size_t pos = activity_hash(key) & activity_mask;
+      while (activity_tab[pos].key) {
+	    if (activity_tab[pos].key == key)
+		  return activity_tab[pos].count;
+	    pos = (pos + 1) & activity_mask;
+      }
+      return 0;
+}
+
+unsigned long vpip_activity_count(vpiHandle obj)
+{
+      if (__vpiSignal*sig = dynamic_cast<__vpiSignal*>(obj))
+	    return activity_count_of(sig->node);
+      if (__vpiRealVar*rvar = dynamic_cast<__vpiRealVar*>(obj))
+	    return activity_count_of(rvar->net);
+      return 0;
+}
+
+struct activity_item_s {
+      std::string name;
+      unsigned long count;
+};
+
+static bool activity_item_cmp(const activity_item_s&a, const activity_item_s&b)
+{
+      if (a.count != b.count)
+	    return a.count > b.count;
+      return a.name < b.name;
+}
+
+/*
+ * Collect the counts of the nets and variables in this scope and its
+ * children. The count of a scope is the sum of the counts of the
+ * items declared directly in it.
+ */
+static void activity_collect(__vpiScope*scope,
+			     std::vector<activity_item_s>&nets,
+			     std::vector<activity_item_s>&scopes)
+{
+      unsigned long total = 0;
+
+      for (unsigned idx = 0 ; idx < scope->intern.size() ; idx += 1) {
+	    vpiHandle item = scope->intern[idx];
+
+	    if (__vpiScope*child = dynamic_cast<__vpiScope*>(item)) {
+		  activity_collect(child, nets, scopes);
+		  continue;
+	    }
+
+	    unsigned long count = vpip_activity_count(item);
+	    if (count == 0)
+		  continue;
+
+	    activity_item_s cur;
+	    cur.name = item->vpi_get_str(vpiFullName);
+	    cur.count = count;
+	    nets.push_back(cur);
+	    total += count;
+      }
+
+      if (total == 0)
+	    return;
+
+      activity_item_s cur;
+      cur.name = scope->vpi_get_str(vpiFullName);
+      cur.count = total;
+      scopes.push_back(cur);
+}
+
+static void activity_print(FILE*fd, const char*title,
+			   std::vector<activity_item_s>&list,
+			   unsigned top, vvp_time64_t now)
+{
+      std::sort(list.begin(), list.end(), activity_item_cmp);
+      if (list.size() > top)
+	    list.resize(top);
+
+      fprintf(fd, "# %s\n", title);
+      fprintf(fd, "# %12s %14s  %s\n", "updates", "per tick", "name");
+      for (unsigned idx = 0 ; idx < list.size() ; idx += 1) {
+	    double rate = now? (double)list[idx].count / (double)now : 0.0;
+	    fprintf(fd, "  %12lu %14.6g  %s\n", list[idx].count, rate,
+		    list[idx].name.c_str());
+      }
+}
+
+void vpip_activity_report(FILE*fd, unsigned top)
+{
+      std::vector<activity_item_s> nets;
+      std::vector<activity_item_s> scopes;
+
+      vpiHandle*roots;
+      unsigned nroots;
+      vpip_make_root_iterator(roots, nroots);
+      for (unsigned idx = 0 ; idx < nroots ; idx += 1) {
+	    if (__vpiScope*scope = dynamic_cast<__vpiScope*>(roots[idx]))
+		  activity_collect(scope, nets, scopes);
+      }
+
+      vvp_time64_t now = schedule_simtime();
+      fprintf(fd, "# Signal activity at time %" TIME_FMT_U " ticks\n", now);
+      activity_print(fd, "Most active nets", nets, top, now);
+      activity_print(fd, "Most active scopes", scopes, top, now);
+}
+
 /*
  * A vvp_fun_signal uses this method to run its callbacks whenever it
  * has a value change. If the cb_rtn is non-nil, then call the
@@ -700,6 +898,9 @@ void vvp_vpi_callback::clear_all_callbacks()
  */
 void vvp_vpi_callback::run_vpi_callbacks()
 {
+      if (vpip_activity_flag)
+	    activity_slot(this) += 1;
+
       struct __vpi_array_word*array_word = array_words_;
       while (array_word) {
 	    array_word->array->word_change(array_word->word);
@@ -27,6 +27,7 @@
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
+# include  <pthread.h>
 # include  "ivl_alloc.h"
 
 extern FILE* vpi_trace;
@@ -55,10 +56,190 @@ static unsigned fd_table_len = 0;
 
 static FILE* logfile;
 
+/*
+ * In asynchronous mode (vvp -a) text written to the MCD files,
+ * including <stdout> and the log file, is not written by the
+ * simulation thread. Each MCD, and the log file, has its own ring
+ * buffer that the text is copied into, and a separate writer thread
+ * drains the rings with the actual (possibly blocking) writes. A ring
+ * is allocated the first time its MCD is written and is then reused,
+ * even after a restart of the writer thread, so a write is only a
+ * copy. Text that does not fit is copied in pieces as the writer
+ * makes room. Anything that uses the FILE objects directly, such as
+ * $fflush, $fclose and the FD based routines, first waits for the
+ * rings to drain.
+ */
+struct mcd_ring_s {
+      FILE*fp;
+      char*buf;
+	/* The oldest queued byte, and the number of bytes queued. */
+      size_t head;
+      size_t fill;
+};
+
+static bool mcd_async_flag = false;
+static pthread_t mcd_work_thread;
+
+static const size_t MCD_RING_SIZE = 64*1024;
+  /* Rings 0-30 match the MCD bits, and this one is the log file. */
+static const unsigned MCD_RING_LOG = 31;
+static struct mcd_ring_s mcd_ring[32];
+  /* The total number of bytes queued in all the rings. */
+static size_t mcd_queue_fill = 0;
+static bool mcd_queue_terminate = false;
+
+static pthread_mutex_t mcd_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  mcd_queue_is_empty_sig = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  mcd_queue_notempty_sig = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  mcd_queue_notfull_sig = PTHREAD_COND_INITIALIZER;
+
+static void* mcd_work_thread_fun(void*)
+{
+      pthread_mutex_lock(&mcd_queue_mutex);
+      for (;;) {
+	    while (mcd_queue_fill == 0 && !mcd_queue_terminate)
+		  pthread_cond_wait(&mcd_queue_notempty_sig, &mcd_queue_mutex);
+	    if (mcd_queue_fill == 0)
+		  break;
+
+	    for (unsigned idx = 0 ; idx < 32 ; idx += 1) {
+		  struct mcd_ring_s*ring = mcd_ring + idx;
+		  if (ring->fill == 0)
+			continue;
+
+		    /* Only this thread removes text, and the writer
+		       only adds text after the queued bytes, so the
+		       contiguous span at the head can be written
+		       without the lock. */
+		  size_t cnt = ring->fill;
+		  if (ring->head + cnt > MCD_RING_SIZE)
+			cnt = MCD_RING_SIZE - ring->head;
+		  FILE*fp = ring->fp;
+		  const char*buf = ring->buf + ring->head;
+		  pthread_mutex_unlock(&mcd_queue_mutex);
+
+		  fwrite(buf, 1, cnt, fp);
+
+		  pthread_mutex_lock(&mcd_queue_mutex);
+		  ring->head = (ring->head + cnt) % MCD_RING_SIZE;
+		  ring->fill -= cnt;
+		  mcd_queue_fill -= cnt;
+		  pthread_cond_signal(&mcd_queue_notfull_sig);
+		  if (mcd_queue_fill == 0)
+			pthread_cond_broadcast(&mcd_queue_is_empty_sig);
+	    }
+      }
+      pthread_mutex_unlock(&mcd_queue_mutex);
+      return 0;
+}
+
+static void mcd_async_write(unsigned idx, FILE*fp, const char*buf, size_t cnt)
+{
+      if (cnt == 0)
+	    return;
+
+      struct mcd_ring_s*ring = mcd_ring + idx;
+
+      pthread_mutex_lock(&mcd_queue_mutex);
+      if (ring->buf == 0)
+	    ring->buf = (char*)malloc(MCD_RING_SIZE);
+	/* A ring is only given a new file when it is empty, because
+	   $fclose waits for the rings to drain. */
+      ring->fp = fp;
+
+      while (cnt > 0) {
+	    while (ring->fill == MCD_RING_SIZE)
+		  pthread_cond_wait(&mcd_queue_notfull_sig, &mcd_queue_mutex);
+
+	    size_t tail = (ring->head + ring->fill) % MCD_RING_SIZE;
+	    size_t room = MCD_RING_SIZE - ring->fill;
+	    if (tail + room > MCD_RING_SIZE)
+		  room = MCD_RING_SIZE - tail;
+	    if (room > cnt)
+		  room = cnt;
+
+	    memcpy(ring->buf + tail, buf, room);
+	    buf += room;
+	    cnt -= room;
+	    ring->fill += room;
+	    mcd_queue_fill += room;
+	    if (mcd_queue_fill == room)
+		  pthread_cond_signal(&mcd_queue_notempty_sig);
+      }
+      pthread_mutex_unlock(&mcd_queue_mutex);
+}
+
+/*
+ * Wait for the writer thread to finish all the queued output. After
+ * this returns the caller may safely use the FILE objects directly.
+ */
+void vpip_mcd_sync(void)
+{
+      if (! mcd_async_flag)
+	    return;
+
+      pthread_mutex_lock(&mcd_queue_mutex);
+      while (mcd_queue_fill > 0)
+	    pthread_cond_wait(&mcd_queue_is_empty_sig, &mcd_queue_mutex);
+      pthread_mutex_unlock(&mcd_queue_mutex);
+}
+
+/*
+ * Drain the rings and stop the writer thread. This is called at the
+ * end of the simulation, and also at exit so that output is not lost
+ * if the program exits some other way.
+ */
+void vpip_mcd_async_stop(void)
+{
+      if (! mcd_async_flag)
+	    return;
+
+      pthread_mutex_lock(&mcd_queue_mutex);
+      mcd_queue_terminate = true;
+      pthread_cond_signal(&mcd_queue_notempty_sig);
+      pthread_mutex_unlock(&mcd_queue_mutex);
+
+      pthread_join(mcd_work_thread, 0);
+      mcd_async_flag = false;
+}
+
+static void mcd_async_atexit(void)
+{
+      vpip_mcd_async_stop();
+}
+
+/*
+ * Start the writer thread. This is normally done by vpip_mcd_init,
+ * but the fork server does it in each forked run instead.
+ */
+void vpip_mcd_async_start(void)
+{
+      static bool atexit_flag = false;
+
+      if (mcd_async_flag)
+	    return;
+
+      mcd_queue_terminate = false;
+      mcd_async_flag = true;
+      pthread_create(&mcd_work_thread, 0, mcd_work_thread_fun, 0);
+      if (! atexit_flag) {
+	    atexit(mcd_async_atexit);
+	    atexit_flag = true;
+      }
+}
+
+static inline void mcd_write(unsigned idx, FILE*fp, const char*buf, size_t cnt)
+{
+      if (mcd_async_flag)
+	    mcd_async_write(idx, fp, buf, cnt);
+      else
+	    fwrite(buf, 1, cnt, fp);
+}
+
 /* Initialize mcd portion of vpi.  Must be called before
  * any vpi_mcd routines can be used.
  */
-void vpip_mcd_init(FILE *log)
+void vpip_mcd_init(FILE *log, bool async_flag)
 {
       fd_table_len = FD_INCR;
       fd_table = (mcd_entry_s *) malloc(fd_table_len*sizeof(mcd_entry_s));
@@ -78,6 +259,9 @@ void vpip_mcd_init(FILE *log)
       fd_table[2].filename = strdup("stderr");
 
       logfile = log;
+
+      if (async_flag)
+	    vpip_mcd_async_start();
 }
 
 #ifdef CHECK_WITH_VALGRIND
@@ -102,6 +286,11 @@ void vpi_mcd_delete(void)
       free(fd_table);
       fd_table = NULL;
       fd_table_len = 0;
+
+      for (unsigned idx = 0 ; idx < 32 ; idx += 1) {
+	    free(mcd_ring[idx].buf);
+	    mcd_ring[idx].buf = 0;
+      }
 }
 #endif
 
@@ -112,6 +301,7 @@ extern "C" PLI_UINT32 vpi_mcd_close(PLI_UINT32 mcd)
 {
 	int rc = 0;
 
+	vpip_mcd_sync();
 	if (IS_MCD(mcd)) {
 		for(int i = 1; i < 31; i++) {
 			if(((mcd>>i) & 1) && mcd_table[i].fp) {
@@ -211,13 +401,16 @@ vpi_mcd_vprintf(PLI_UINT32 mcd, const char*fmt, va_list ap)
       }
       va_end(saved_ap);
 
+	/* Like fputs, stop at the first NUL in the formatted text. */
+      size_t len = strlen(buf_ptr);
+
       for(int i = 0; i < 31; i++) {
 	    if((mcd>>i) & 1) {
 		  if(mcd_table[i].fp) {
 			  // echo to logfile
 			if (i == 0 && logfile)
-			      fputs(buf_ptr, logfile);
-			fputs(buf_ptr, mcd_table[i].fp);
+			      mcd_write(MCD_RING_LOG, logfile, buf_ptr, len);
+			mcd_write(i, mcd_table[i].fp, buf_ptr, len);
 		  } else {
 			rc = EOF;
 		  }
@@ -248,9 +441,9 @@ extern "C" void vpip_mcd_rawwrite(PLI_UINT32 mcd, const char*buf, size_t cnt)
 	    if (mcd_table[idx].fp == 0)
 		  continue;
 
-	    fwrite(buf, 1, cnt, mcd_table[idx].fp);
+	    mcd_write(idx, mcd_table[idx].fp, buf, cnt);
 	    if (idx == 0 && logfile)
-		  fwrite(buf, 1, cnt, logfile);
+		  mcd_write(MCD_RING_LOG, logfile, buf, cnt);
 
       }
 }
@@ -259,6 +452,7 @@ extern "C" PLI_INT32 vpi_mcd_flush(PLI_UINT32 mcd)
 {
 	int rc = 0;
 
+	vpip_mcd_sync();
 	if (IS_MCD(mcd)) {
 		for(int i = 0; i < 31; i++) {
 			if((mcd>>i) & 1) {
@@ -326,5 +520,8 @@ extern "C" FILE *vpi_get_file(PLI_INT32 fd)
 	// Only know about fd_table_len indices
       if (FD_IDX(fd) >= fd_table_len) return NULL;
 
+	// The caller will use the FILE directly, and it may be
+	// <stdout> or <stderr>, so make sure queued output is out.
+      vpip_mcd_sync();
       return fd_table[FD_IDX(fd)].fp;
 }
@@ -105,7 +105,7 @@ struct vpip_string_chunk {
 
 unsigned vpip_size(__vpiSignal *sig)
 {
-      return abs(sig->msb.get_value() - sig->lsb.get_value()) + 1;
+      return abs(sig->msb - sig->lsb) + 1;
 }
 
 __vpiScope* vpip_scope(__vpiSignal*sig)
@@ -1278,79 +1278,74 @@ vpiHandle vpi_handle_by_index(vpiHandle ref, PLI_INT32 idx)
 
 static vpiHandle find_name(const char *name, vpiHandle handle)
 {
-      vpiHandle rtn = 0;
       __vpiScope*ref = dynamic_cast<__vpiScope*>(handle);
 
       /* check module names */
-      if (!strcmp(name, vpi_get_str(vpiName, handle)))
-	    rtn = handle;
-
-      /* brute force search for the name in all objects in this scope */
-      for (unsigned i = 0 ;  i < ref->intern.size() ;  i += 1) {
-	      /* The standard says that since a port does not have a full
-	       * name it cannot be found by name. Because of this we need
-	       * to skip ports here so the correct handle can be located. */
-	    if (vpi_get(vpiType, ref->intern[i]) == vpiPort) continue;
-	    char *nm = vpi_get_str(vpiName, ref->intern[i]);
+      if (!strcmp(name, ref->scope_name()))
+	    return handle;
+
+      /* Look the name up in the name index of the scope. Ports are
+       * not in the index, because the standard says that since a port
+       * does not have a full name it cannot be found by name. */
+      vpiHandle rtn = ref->name_index.find_item(ref->intern, name);
+      if (rtn)
+	    return rtn;
+
+      /* The name may be a word of a memory, i.e. "mem[3]". Look up
+       * the memory by its base name and search only its words. */
+      const char*sel = strchr(name, '[');
+      if (sel == 0)
+	    return 0;
+
+      string base (name, sel - name);
+      vpiHandle arr = ref->name_index.find_item(ref->intern, base.c_str());
+      if (arr == 0)
+	    return 0;
+      if (vpi_get(vpiType, arr) != vpiMemory &&
+          vpi_get(vpiType, arr) != vpiNetArray)
+	    return 0;
+
+      vpiHandle word_i, word_h;
+      word_i = vpi_iterate(vpiMemoryWord, arr);
+      while (word_i && (word_h = vpi_scan(word_i))) {
+	    char *nm = vpi_get_str(vpiName, word_h);
 	    if (!strcmp(name, nm)) {
-		  rtn = ref->intern[i];
-		  break;
-	    } else if (vpi_get(vpiType, ref->intern[i]) == vpiMemory ||
-	               vpi_get(vpiType, ref->intern[i]) == vpiNetArray) {
-		  /* We need to iterate on the words */
-		  vpiHandle word_i, word_h;
-		  word_i = vpi_iterate(vpiMemoryWord, ref->intern[i]);
-		  while (word_i && (word_h = vpi_scan(word_i))) {
-			nm = vpi_get_str(vpiName, word_h);
-			if (!strcmp(name, nm)) {
-			      rtn = word_h;
-			      vpi_free_object(word_i);
-			      break;
-			}
-		  }
+		  vpi_free_object(word_i);
+		  return word_h;
 	    }
-	    /* found it yet? */
-	    if (rtn) break;
       }
 
-      return rtn;
+      return 0;
 }
 
-static vpiHandle find_scope(const char *name, vpiHandle handle, int depth)
+/*
+ * Find the scope with the dotted path name, starting at the handle
+ * scope, or the root table if the handle is nil. Each level of the
+ * path is looked up in the name index of the scope above it.
+ */
+static vpiHandle find_scope(const char *name, vpiHandle handle)
 {
+      const char*nm_first = name;
+      while (nm_first) {
+	    const char*nm_rest = strchr(nm_first, '.');
+	    string nm = nm_rest? string(nm_first, nm_rest-nm_first) : nm_first;
 
-      vpiHandle iter = handle==0
-	    ? vpi_iterate(vpiModule, NULL)
-	    : vpi_iterate(vpiInternalScope, handle);
-
-      vector<char> name_buf (strlen(name)+1);
-      strcpy(&name_buf[0], name);
-      char*nm_first = &name_buf[0];
-      char*nm_rest = strchr(nm_first, '.');
-      if (nm_rest) {
-	    *nm_rest++ = 0;
-      }
-
-      vpiHandle rtn = 0;
-      vpiHandle hand;
-      while (iter && (hand = vpi_scan(iter))) {
-	    char *nm = vpi_get_str(vpiName, hand);
-
-	    if (strcmp(nm_first,nm)==0) {
-		  if (nm_rest)
-			rtn=find_scope(nm_rest, hand, depth+1);
-		  else
-			rtn = hand;
+	    if (handle == 0) {
+		  handle = vpip_find_root_scope(nm.c_str());
+	    } else {
+		  __vpiScope*ref = dynamic_cast<__vpiScope*>(handle);
+		  assert(ref);
+		  handle = ref->name_index.find_scope(ref->intern, nm.c_str(),
+						      false);
 	    }
 
-	    /* found it yet ? */
-	    if (rtn) {
-		  vpi_free_object(iter);
-		  break;
-	    }
+	    if (handle == 0)
+		  return 0;
+
+	    nm_first = nm_rest? nm_rest+1 : 0;
       }
 
-      return rtn;
+      return handle;
 }
 
 vpiHandle vpi_handle_by_name(const char *name, vpiHandle scope)
@@ -1403,7 +1398,7 @@ vpiHandle vpi_handle_by_name(const char *name, vpiHandle scope)
 	      // passed in. That suggests we are looking for "a.b.c"
 	      // in the root scope. So convert "a.b" to a scope and
 	      // start there to look for "c".
-	    hand = find_scope(nm_path, NULL, 0);
+	    hand = find_scope(nm_path, NULL);
 	    nm_path = 0;
 
       } else {
@@ -1411,7 +1406,7 @@ vpiHandle vpi_handle_by_name(const char *name, vpiHandle scope)
 	      // the root, and there is no path to the name, i.e. the
 	      // string is "c" instead of "top.c". Try to find "c" as
 	      // a scope and return that.
-	    hand = find_scope(nm_base, NULL, 0);
+	    hand = find_scope(nm_base, NULL);
       }
 
       if (hand == 0) {
@@ -1428,10 +1423,10 @@ vpiHandle vpi_handle_by_name(const char *name, vpiHandle scope)
 	// the nm_path string is a.b and we search for that
 	// scope. If we find it, then set hand to that scope.
       if (nm_path) {
-	    vpiHandle tmp = find_scope(nm_path, hand, 0);
+	    vpiHandle tmp = find_scope(nm_path, hand);
 	    while (tmp == 0 && hand != 0) {
 		  hand = vpi_handle(vpiScope, hand);
-		  tmp = find_scope(nm_path, hand, 0);
+		  tmp = find_scope(nm_path, hand);
 	    }
 	    hand = tmp;
       }
@@ -1530,6 +1525,9 @@ extern "C" void vpi_sim_vcontrol(int operation, va_list ap)
 	  case vpiFinish:
 	  case __ivl_legacy_vpiFinish:
             diag_msg = va_arg(ap, long);
+	      /* Write out the queued output now, in case the
+		 simulation does not end normally after this. */
+	    vpip_mcd_sync();
 	    schedule_finish(diag_msg);
 	    break;
 
@@ -1540,6 +1538,9 @@ extern "C" void vpi_sim_vcontrol(int operation, va_list ap)
 	    break;
 
 	  default:
+	      /* The assert does not run the atexit functions, so
+		 the queued output is written out first. */
+	    vpip_mcd_sync();
 	    fprintf(stderr, "Unsupported operation %d.\n", operation);
 	    assert(0);
       }
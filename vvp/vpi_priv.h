@@ -28,6 +28,7 @@
 # include  <set>
 # include  <string>
 # include  <vector>
+# include  <cstdio>
 
 /*
  * Added to use some "vvp_fun_modpath_src"
@@ -60,6 +61,16 @@ extern bool code_is_instrumented;
 extern vpiHandle vpip_build_file_line(char*description,
                                       long file_idx, long lineno);
 
+/*
+ * Signal activity counting (vvp -T). When the flag is set, each value
+ * update of a net or variable is counted. vpip_activity_count returns
+ * the count for a signal or real variable handle, and
+ * vpip_activity_report writes the top most active nets and scopes.
+ */
+extern bool vpip_activity_flag;
+extern unsigned long vpip_activity_count(vpiHandle obj);
+extern void vpip_activity_report(FILE*fd, unsigned top);
+
 /*
  * Private VPI properties that are only used in the cleanup code.
  */
@@ -228,6 +239,33 @@ struct __vpiScopedRealtime : public __vpiSystemTime {
       void vpi_get_value(p_vpi_value val);
 };
 
+/*
+ * The __vpiNameIndex maps the base names of the items in a scope (or
+ * in the root table) to the handle of the first item with that name.
+ * The vpi_handle_by_name function uses this to find scopes and items
+ * without a linear search. The index is built lazily the first time
+ * it is needed, and is brought up to date on each lookup with any
+ * items that were added to the table since then.
+ */
+struct __vpiNameIndex {
+      __vpiNameIndex() : count_(0) { }
+
+	// Find the named child scope or (non-port) item.
+      vpiHandle find_scope(const std::vector<vpiHandle>&table,
+			   const char*name, bool root_flag);
+      vpiHandle find_item(const std::vector<vpiHandle>&table,
+			  const char*name);
+	// Forget everything, for when the table is cleared.
+      void clear();
+
+    private:
+      void update_(const std::vector<vpiHandle>&table, bool root_flag);
+
+      unsigned count_;
+      std::map<std::string,vpiHandle> scopes_;
+      std::map<std::string,vpiHandle> items_;
+};
+
 /*
  * Scopes are created by .scope statements in the source. These
  * objects hold the items and properties that are knowingly bound to a
@@ -263,6 +301,8 @@ class __vpiScope : public __vpiHandle {
       struct __vpiScopedRealtime scoped_realtime;
 	/* Keep an array of internal scope items. */
       std::vector<class __vpiHandle*> intern;
+	/* Name index of the intern items, built on demand. */
+      struct __vpiNameIndex name_index;
 	/* Set of types */
       std::map<std::string,class_type*> classes;
         /* Keep an array of items to be automatically allocated */
@@ -321,6 +361,7 @@ extern __vpiScope* vpip_peek_context_scope(void);
 extern unsigned vpip_add_item_to_context(automatic_hooks_s*item,
                                          __vpiScope*scope);
 extern vpiHandle vpip_make_root_iterator(void);
+extern vpiHandle vpip_find_root_scope(const char*name);
 extern void vpip_make_root_iterator(class __vpiHandle**&table,
 				    unsigned&ntable);
 
@@ -350,8 +391,10 @@ struct __vpiSignal : public __vpiHandle {
             const char*name;
             vpiHandle index;
       } id;
-	/* The indices that define the width and access offset. */
-      __vpiDecConst msb, lsb;
+	/* The indices that define the width and access offset. The
+	   vpiLeftRange/vpiRightRange handles for these are only made
+	   if VPI asks for them (see signal_get_handle). */
+      int msb, lsb;
 	/* Flags */
       unsigned signed_flag  : 1;
       unsigned is_netarray  : 1; // This is word of a net array
@@ -945,6 +988,20 @@ extern vvp_time64_t vpip_scaled_real_to_time64(double val, __vpiScope*sc);
 extern const char* vpip_string(const char*str);
 extern const char* vpip_name_string(const char*str);
 
+/*
+ * When vvp is run with asynchronous output (-a) the MCD output is
+ * written by a separate thread. The vpip_mcd_sync function waits for
+ * all the queued output to be written, and must be called before
+ * writing to <stdout> or the log file other than through the MCD
+ * functions. The vpip_mcd_async_stop function also stops the thread,
+ * and vpip_mcd_async_start starts it (again). The output is also
+ * drained at exit, at $finish and before an unsupported vpi_control
+ * operation asserts.
+ */
+extern void vpip_mcd_sync(void);
+extern void vpip_mcd_async_start(void);
+extern void vpip_mcd_async_stop(void);
+
 
 /*
  * This function is used to make decimal string versions of various
@@ -25,6 +25,7 @@
 # include  "vvp_cleanup.h"
 #endif
 # include  <cstdio>
+# include  <climits>
 # include  <cstdlib>
 # include  <cstring>
 # include  <cassert>
@@ -47,6 +48,11 @@ static int real_var_get(int code, vpiHandle ref)
 
 	case vpiAutomatic:
 	  return vpip_scope(rfp)->is_automatic()? 1 : 0;
+
+	case _vpiActivity: {
+	  unsigned long count = vpip_activity_count(rfp);
+	  return count > INT_MAX? INT_MAX : (int)count;
+	}
       }
 
       return 0;
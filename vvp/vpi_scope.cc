@@ -21,6 +21,7 @@
 # include  "vpi_priv.h"
 # include  "symbols.h"
 # include  "statistics.h"
+# include  "vthread.h"
 # include  "config.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
@@ -34,6 +35,7 @@
 using namespace std;
 
 static vector<vpiHandle> vpip_root_table;
+static __vpiNameIndex vpip_root_index;
 
 vpiHandle vpip_make_root_iterator(void)
 {
@@ -155,6 +157,7 @@ void root_table_delete(void)
 	    delete scope;
       }
       vpip_root_table.clear();
+      vpip_root_index.clear();
 
 	/* Clean up all the class definitions. */
       for (unsigned idx = 0; idx < class_list_count; idx += 1) {
@@ -326,6 +329,69 @@ static vpiHandle module_iter(int code, vpiHandle obj)
       return module_iter_subset(code, ref);
 }
 
+/*
+ * Add to the index any items that were added to the table since the
+ * last time the index was consulted. Only the first item with a given
+ * name is recorded, so that the index finds the same handle that a
+ * linear search of the table would find.
+ */
+void __vpiNameIndex::update_(const vector<vpiHandle>&table, bool root_flag)
+{
+      for ( ; count_ < table.size() ;  count_ += 1) {
+	    vpiHandle item = table[count_];
+	    int type = item->get_type_code();
+
+	    if (root_flag || compare_types(vpiInternalScope, type)) {
+		  __vpiScope*scope = static_cast<__vpiScope*>(item);
+		  scopes_.insert(make_pair(string(scope->scope_name()), item));
+	    }
+
+	      /* The standard says that since a port does not have a
+		 full name it cannot be found by name. */
+	    if (root_flag || type == vpiPort)
+		  continue;
+
+	    char*nm = item->vpi_get_str(vpiName);
+	    if (nm) items_.insert(make_pair(string(nm), item));
+      }
+}
+
+void __vpiNameIndex::clear()
+{
+      count_ = 0;
+      scopes_.clear();
+      items_.clear();
+}
+
+vpiHandle __vpiNameIndex::find_scope(const vector<vpiHandle>&table,
+				     const char*name, bool root_flag)
+{
+      update_(table, root_flag);
+
+      map<string,vpiHandle>::const_iterator cur = scopes_.find(name);
+      if (cur == scopes_.end())
+	    return 0;
+
+      return cur->second;
+}
+
+vpiHandle __vpiNameIndex::find_item(const vector<vpiHandle>&table,
+				    const char*name)
+{
+      update_(table, false);
+
+      map<string,vpiHandle>::const_iterator cur = items_.find(name);
+      if (cur == items_.end())
+	    return 0;
+
+      return cur->second;
+}
+
+vpiHandle vpip_find_root_scope(const char*name)
+{
+      return vpip_root_index.find_scope(vpip_root_table, name, true);
+}
+
 
 __vpiScope::__vpiScope(const char*nam, const char*tnam, bool auto_flag)
 : is_automatic_(auto_flag)
@@ -549,6 +615,8 @@ compile_scope_decl(char*label, char*type, char*name, char*tname,
       else scope->is_cell = false;
 
       current_scope = scope;
+      if (vthread_profile_flag)
+	    vthread_profile_scope(current_scope);
 
       compile_vpi_symbol(label, scope);
 
@@ -588,6 +656,8 @@ void compile_scope_recall(char*symbol)
 	   type punned pointer warning from some gcc compilers. */
       compile_vpi_lookup((vpiHandle*)(void*)&current_scope, symbol);
       assert(current_scope);
+      if (vthread_profile_flag)
+	    vthread_profile_scope(current_scope);
 }
 
 /*
@@ -570,15 +570,15 @@ static int signal_get(int code, vpiHandle ref)
 		  return vpiUndefined;
 
 	  case vpiLeftRange:
-            return rfp->msb.get_value();
+            return rfp->msb;
 
 	  case vpiRightRange:
-            return rfp->lsb.get_value();
+            return rfp->lsb;
 
 	  case vpiScalar:
-	    return (rfp->msb.get_value() == 0 && rfp->lsb.get_value() == 0);
+	    return (rfp->msb == 0 && rfp->lsb == 0);
 	  case vpiVector:
-	    return (rfp->msb.get_value() != rfp->lsb.get_value());
+	    return (rfp->msb != rfp->lsb);
 
           case vpiAutomatic:
             return vpip_scope(rfp)->is_automatic() ? 1  : 0;
@@ -588,9 +588,14 @@ static int signal_get(int code, vpiHandle ref)
             return _vpiNoThr;
 #endif
 
+	  case _vpiActivity: {
+	    unsigned long count = vpip_activity_count(rfp);
+	    return count > INT_MAX? INT_MAX : (int)count;
+	  }
+
 	    // This private property must return zero when undefined.
 	  case _vpiNexusId:
-	    if (rfp->msb.get_value() == rfp->lsb.get_value())
+	    if (rfp->msb == rfp->lsb)
 		  return (int) (uintptr_t) rfp->node;
 	    else
 		  return 0;
@@ -631,6 +636,25 @@ static char* signal_get_str(int code, vpiHandle ref)
       return rbuf;
 }
 
+/*
+ * Most signals never have their range handles looked at, so rather
+ * than carry two constant handles in every __vpiSignal, make the pair
+ * the first time VPI asks for one and keep it so that later calls
+ * return the same handles.
+ */
+static std::map<const __vpiSignal*,__vpiDecConst*> signal_ranges;
+
+static __vpiDecConst* signal_range_handles(const __vpiSignal*rfp)
+{
+      __vpiDecConst*&range = signal_ranges[rfp];
+      if (range == 0) {
+	    range = new __vpiDecConst[2];
+	    range[0].set_value(rfp->msb);
+	    range[1].set_value(rfp->lsb);
+      }
+      return range;
+}
+
 static vpiHandle signal_get_handle(int code, vpiHandle ref)
 {
       struct __vpiSignal*rfp = dynamic_cast<__vpiSignal*>(ref);
@@ -645,9 +669,9 @@ static vpiHandle signal_get_handle(int code, vpiHandle ref)
 	    return rfp->is_netarray? rfp->id.index : 0;
 
 	  case vpiLeftRange:
-	    return &rfp->msb;
+	    return signal_range_handles(rfp) + 0;
 	  case vpiRightRange:
-	    return &rfp->lsb;
+	    return signal_range_handles(rfp) + 1;
 
 	  case vpiScope:
 	    return vpip_scope(rfp);
@@ -676,10 +700,10 @@ static vpiHandle signal_index(int idx, vpiHandle ref)
       struct __vpiSignal*rfp = dynamic_cast<__vpiSignal*>(ref);
       assert(rfp);
 	/* Check to see if the index is in range. */
-      if (rfp->msb.get_value() >= rfp->lsb.get_value()) {
-	    if ((idx > rfp->msb.get_value()) || (idx < rfp->lsb.get_value())) return 0;
+      if (rfp->msb >= rfp->lsb) {
+	    if ((idx > rfp->msb) || (idx < rfp->lsb)) return 0;
       } else {
-	    if ((idx < rfp->msb.get_value()) || (idx > rfp->lsb.get_value())) return 0;
+	    if ((idx < rfp->msb) || (idx > rfp->lsb)) return 0;
       }
 	/* Return a handle for the individual bit. */
       cerr << "Sorry: Icarus does not currently support "
@@ -691,9 +715,9 @@ static vpiHandle signal_index(int idx, vpiHandle ref)
 
 unsigned __vpiSignal::width(void) const
 {
-      unsigned wid = (msb.get_value() >= lsb.get_value())
-	    ? (msb.get_value() - lsb.get_value() + 1)
-	    : (lsb.get_value() - msb.get_value() + 1);
+      unsigned wid = (msb >= lsb)
+	    ? (msb - lsb + 1)
+	    : (lsb - msb + 1);
 
       return wid;
 }
@@ -835,9 +859,9 @@ static vpiHandle signal_put_value(vpiHandle ref, s_vpi_value*vp, int flags)
 	/* Make a vvp_vector4_t vector to receive the translated value
 	   that we are going to poke. This will get populated
 	   differently depending on the format. */
-      wid = (rfp->msb.get_value() >= rfp->lsb.get_value())
-	    ? (rfp->msb.get_value() - rfp->lsb.get_value() + 1)
-	    : (rfp->lsb.get_value() - rfp->msb.get_value() + 1);
+      wid = (rfp->msb >= rfp->lsb)
+	    ? (rfp->msb - rfp->lsb + 1)
+	    : (rfp->lsb - rfp->msb + 1);
 
       vvp_vector4_t val = vec4_from_vpi_value(vp, wid);
 
@@ -1116,6 +1140,11 @@ void signal_pool_delete()
       free(signal_pool);
       signal_pool = 0;
       signal_pool_count = 0;
+
+      for (std::map<const __vpiSignal*,__vpiDecConst*>::iterator cur
+		 = signal_ranges.begin() ; cur != signal_ranges.end() ; ++ cur)
+	    delete[]cur->second;
+      signal_ranges.clear();
 }
 #endif
 
@@ -1131,8 +1160,8 @@ static vpiHandle fill_in_net4(struct __vpiSignal*obj, __vpiScope*scope,
 			      bool signed_flag, vvp_net_t*node)
 {
       obj->id.name = name? vpip_name_string(name) : 0;
-      obj->msb = __vpiDecConst(msb);
-      obj->lsb = __vpiDecConst(lsb);
+      obj->msb = msb;
+      obj->lsb = lsb;
       obj->signed_flag = signed_flag? 1 : 0;
       obj->is_netarray = 0;
       obj->node = node;
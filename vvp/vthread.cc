@@ -32,10 +32,13 @@
 # include  "vvp_cleanup.h"
 #endif
 # include  <set>
+# include  <map>
+# include  <algorithm>
 # include  <typeinfo>
 # include  <vector>
 # include  <cstdlib>
 # include  <climits>
+# include  <stdint.h>
 # include  <cstring>
 # include  <cmath>
 # include  <cassert>
@@ -680,6 +683,121 @@ void vthread_delay_delete()
 	    running_thread->delay_delete = 1;
 }
 
+bool vthread_profile_flag = false;
+
+/*
+ * The profile has a flat array of counts for each chunk of the code
+ * space, indexed by the position of the instruction in the chunk. The
+ * table of chunks is sorted by address so that the chunk of an
+ * instruction can be found, but the profiled loop only does that when
+ * the thread leaves the chunk it was in. The scope and source line of
+ * each instruction are only worked out when the report is written,
+ * from the list of the points in the code space where compile changed
+ * the current scope.
+ */
+struct profile_chunk_s {
+      vvp_code_t base;
+      unsigned long*counts;
+};
+
+struct profile_scope_s {
+      vvp_code_t code;
+      __vpiScope*scope;
+};
+
+static vector<profile_chunk_s> profile_chunks;
+static vector<profile_scope_s> profile_scopes;
+static vvp_code_t profile_end = 0;
+
+static bool profile_chunk_less(const profile_chunk_s&a,
+			       const profile_chunk_s&b)
+{
+      return (uintptr_t)a.base < (uintptr_t)b.base;
+}
+
+void vthread_profile_scope(__vpiScope*scope)
+{
+      profile_scope_s cur;
+      cur.code = codespace_next();
+      cur.scope = scope;
+      profile_scopes.push_back(cur);
+}
+
+static void profile_init(void)
+{
+	/* The code space is complete when the simulation starts. */
+      profile_end = codespace_next();
+
+      for (vvp_code_t chunk = codespace_null() ; chunk
+		 ; chunk = chunk[code_chunk_size-1].cptr) {
+	    profile_chunk_s cur;
+	    cur.base = chunk;
+	    cur.counts = new unsigned long[code_chunk_size];
+	    memset(cur.counts, 0, code_chunk_size*sizeof(unsigned long));
+	    profile_chunks.push_back(cur);
+      }
+
+      sort(profile_chunks.begin(), profile_chunks.end(), profile_chunk_less);
+}
+
+static unsigned long* profile_chunk_counts(vvp_code_t cp, vvp_code_t&base)
+{
+      if (profile_chunks.empty())
+	    profile_init();
+
+      size_t lo = 0, hi = profile_chunks.size();
+      while (lo < hi) {
+	    size_t mid = (lo + hi) / 2;
+	    if ((uintptr_t)profile_chunks[mid].base <= (uintptr_t)cp)
+		  lo = mid + 1;
+	    else
+		  hi = mid;
+      }
+
+      assert(lo > 0);
+      profile_chunk_s&chunk = profile_chunks[lo-1];
+      assert(cp < chunk.base + code_chunk_size);
+      base = chunk.base;
+      return chunk.counts;
+}
+
+#ifdef CHECK_WITH_VALGRIND
+void profile_delete(void)
+{
+      for (size_t idx = 0 ; idx < profile_chunks.size() ; idx += 1)
+	    delete[] profile_chunks[idx].counts;
+      profile_chunks.clear();
+      profile_scopes.clear();
+}
+#endif
+
+/*
+ * This is the instruction loop of vthread_run with the profile
+ * counting added. It is kept separate so that the normal loop does
+ * not pay for it.
+ */
+static void vthread_run_profiled(vthread_t thr)
+{
+      vvp_code_t base = 0;
+      unsigned long*counts = 0;
+
+      for (;;) {
+	    vvp_code_t cp = thr->pc;
+	    thr->pc += 1;
+
+	    uintptr_t off = ((uintptr_t)cp - (uintptr_t)base) / sizeof *cp;
+	    if (off >= code_chunk_size) {
+		  counts = profile_chunk_counts(cp, base);
+		  off = cp - base;
+	    }
+	    counts[off] += 1;
+
+	    bool rc = (cp->opcode)(thr, cp);
+	    if (rc == false)
+		  break;
+      }
+}
+
 /*
  * This function runs each thread by fetching an instruction,
  * incrementing the PC, and executing the instruction. The thread may
@@ -696,7 +814,10 @@ void vthread_run(vthread_t thr)
 
             running_thread = thr;
 
-	    for (;;) {
+	    if (vthread_profile_flag) {
+		  vthread_run_profiled(thr);
+
+	    } else for (;;) {
 		  vvp_code_t cp = thr->pc;
 		  thr->pc += 1;
 
@@ -713,6 +834,83 @@ void vthread_run(vthread_t thr)
       running_thread = 0;
 }
 
+struct profile_key_s {
+      __vpiScope*scope;
+      vvp_code_t line;
+      vvp_code_fun opcode;
+
+      bool operator < (const profile_key_s&that) const
+      { if (scope != that.scope) return scope < that.scope;
+	if (line != that.line) return line < that.line;
+	return opcode < that.opcode;
+      }
+};
+
+/*
+ * Walk the code space in the order it was compiled, keeping track of
+ * the current scope and the last %file_line, and add the count of
+ * each instruction to its scope, line and opcode.
+ */
+void vthread_profile_write(FILE*fd)
+{
+      map<profile_key_s,unsigned long> totals;
+      profile_key_s key;
+      key.scope = 0;
+      key.line = 0;
+
+      size_t next_scope = 0;
+      vvp_code_t chunk = profile_chunks.empty()? 0 : codespace_null();
+      for ( ; chunk ; chunk = chunk[code_chunk_size-1].cptr) {
+	    vvp_code_t base;
+	    unsigned long*counts = profile_chunk_counts(chunk, base);
+
+	    for (unsigned idx = 0 ; idx < code_chunk_size ; idx += 1) {
+		  vvp_code_t cp = chunk + idx;
+		  if (cp == profile_end)
+			break;
+
+		  while (next_scope < profile_scopes.size()
+			 && profile_scopes[next_scope].code == cp) {
+			key.scope = profile_scopes[next_scope].scope;
+			key.line = 0;
+			next_scope += 1;
+		  }
+
+		  if (cp->opcode == &of_FILE_LINE)
+			key.line = cp;
+
+		  if (counts[idx] == 0)
+			continue;
+
+		  key.opcode = cp->opcode;
+		  totals[key] += counts[idx];
+	    }
+      }
+
+      for (map<profile_key_s,unsigned long>::const_iterator cur
+		 = totals.begin() ; cur != totals.end() ; ++ cur) {
+	    const profile_key_s&item = cur->first;
+
+	      /* The scope path, with the hierarchy separated by ';'
+		 so that each scope level is a frame of the stack. */
+	    string path = item.scope? vpi_get_str(vpiFullName, item.scope) : "-";
+	    for (size_t idx = 0 ;  idx < path.size() ;  idx += 1) {
+		  if (path[idx] == '.')
+			path[idx] = ';';
+	    }
+
+	    fputs(path.c_str(), fd);
+	    if (item.line) {
+		  vpiHandle handle = item.line->handle;
+		  fprintf(fd, ";%s:%d", vpi_get_str(vpiFile, handle),
+			  (int)vpi_get(vpiLineNo, handle));
+	    }
+
+	    const char*mnem = vvp_opcode_mnemonic(item.opcode);
+	    fprintf(fd, ";%s %lu\n", mnem? mnem : "?", cur->second);
+      }
+}
+
 /*
  * The CHUNK_LINK instruction is a special next pointer for linking
  * chunks of code space. It's like a simplified %jmp.
@@ -22,6 +22,7 @@
 # include  "vvp_net.h"
 
 # include  <string>
+# include  <cstdio>
 
 /*
  * A vthread is a simulation thread that executes instructions when
@@ -65,6 +66,21 @@ extern void vthread_delay_delete();
  */
 extern void vthread_run(vthread_t thr);
 
+/*
+ * When the vthread_profile_flag is set (vvp -p), vthread_run counts
+ * every instruction it executes by its address. Compile calls the
+ * vthread_profile_scope function each time the current scope changes,
+ * so that the code after that point is known to be of that scope. The
+ * vthread_profile_write function adds up the counts by scope, the
+ * source location of the %file_line instruction before each
+ * instruction, and the opcode. It writes them as "folded stacks", one
+ * "scope;...;file:line;opcode count" line per entry, that flame graph
+ * tools can read directly.
+ */
+extern bool vthread_profile_flag;
+extern void vthread_profile_scope(__vpiScope*scope);
+extern void vthread_profile_write(FILE*fd);
+
 /*
  * This function schedules all the threads in the list to be scheduled
  * for execution with delay 0. The thr pointer is taken to be the head
@@ -25,6 +25,7 @@
 
 /* Routines used to cleanup the runtime memory when it is all finished. */
 
+extern void activity_delete(void);
 extern void codespace_delete(void);
 extern void dec_str_delete(void);
 extern void def_table_delete(void);
@@ -32,6 +33,7 @@ extern void island_delete(void);
 extern void vpi_mcd_delete(void);
 extern void load_module_delete(void);
 extern void modpath_delete(void);
+extern void profile_delete(void);
 extern void root_table_delete(void);
 extern void schedule_delete(void);
 extern void signal_pool_delete(void);
@@ -41,6 +41,7 @@ class vvp_vpi_callback {
       void attach_as_word(struct __vpiArray* arr, unsigned long addr);
 
       void add_vpi_callback(value_callback*);
+
 #ifdef CHECK_WITH_VALGRIND
 	/* This has only been tested at EOS. */
       void clear_all_callbacks(void);